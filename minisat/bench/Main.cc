@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !(defined(__MINGW32__) || defined(_MSC_VER))
+#include <sys/resource.h>
+#endif
+
+#include "minisat/core/CnfLoader.h"
+#include "minisat/core/Dimacs.h"
+#include "minisat/core/EA.h"
+#include "minisat/core/OutOfMemoryException.h"
+#include "minisat/core/Solver.h"
+#include "minisat/utils/Options.h"
+#include "minisat/utils/System.h"
+
+using namespace Minisat;
+
+//=================================================================================================
+// Reproducible throughput benchmarks of the backdoor search.
+//
+// Every line of the suite file names a formula (relative to the suite file) and a backdoor size.
+// For each formula three fixed-seed workloads are timed: an EA run, and walking the same random
+// backdoors with 'gen_all_valid_assumptions_tree' and 'gen_all_valid_assumptions_propcheck'.
+// The results are written as one JSON object.
+
+namespace {
+
+struct Entry {
+    std::string name;  // as given in the suite file
+    std::string path;
+    int size = 0;
+};
+
+struct Measure {
+    std::string instance;
+    std::string workload;
+    int size = 0;
+    double seconds = 0;
+    uint64_t evaluations = 0;  // backdoors evaluated (EA: cache misses)
+    uint64_t propagations = 0;
+    uint64_t nodes = 0;
+    uint64_t hard = 0;         // hard tasks in total (EA: of the best backdoor)
+    double cacheHitRate = -1;  // EA only
+    double peakRss = 0;        // MB, of the process so far
+};
+
+double peakRssMB() {
+#if !(defined(__MINGW32__) || defined(_MSC_VER))
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#else
+    return memUsedPeak();
+#endif
+}
+
+bool readSuite(const std::string &path, std::vector<Entry> &entries) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string dir = path.find('/') == std::string::npos ? "" : path.substr(0, path.rfind('/') + 1);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        Entry entry;
+        if (!(fields >> entry.name) || entry.name[0] == '#') continue;
+        if (!(fields >> entry.size) || entry.size <= 0) {
+            fprintf(stderr, "ERROR! Bad suite line: %s\n", line.c_str());
+            return false;
+        }
+        entry.path = dir + entry.name;
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+bool loadFormula(const std::string &path, Solver &S) {
+    CnfData cnf;
+    if (readDimacsMapped(path.c_str(), 1, cnf)) {
+        addToSolver(cnf, S);
+    } else {
+        FILE *in = fopen(path.c_str(), "rb");
+        if (in == NULL) return false;
+        parse_DIMACS(in, S);
+        fclose(in);
+    }
+    S.simplify();
+    return true;
+}
+
+// Unassigned variables occurring in some clause, as the EA pool of 'Main.cc'
+std::vector<int> makePool(const Solver &S) {
+    std::vector<bool> occurs(S.nVars(), false);
+    for (ClauseIterator it = S.clausesBegin(); it != S.clausesEnd(); ++it) {
+        const Clause &c = *it;
+        for (int i = 0; i < c.size(); ++i) occurs[var(c[i])] = true;
+    }
+    std::vector<int> pool;
+    for (Var v = 0; v < S.nVars(); ++v) {
+        if (occurs[v] && S.value(v) == l_Undef) pool.push_back(v);
+    }
+    return pool;
+}
+
+void printDouble(FILE *f, double x) {
+    fprintf(f, "%.6g", x);
+}
+
+void printMeasure(FILE *f, const Measure &m) {
+    double rate = m.seconds > 0 ? 1 / m.seconds : 0;
+    fprintf(f, "    {\"instance\":\"%s\",\"workload\":\"%s\",\"size\":%d,\"seconds\":", m.instance.c_str(), m.workload.c_str(), m.size);
+    printDouble(f, m.seconds);
+    fprintf(f, ",\"evaluations\":%" PRIu64 ",\"evaluations_per_sec\":", m.evaluations);
+    printDouble(f, m.evaluations * rate);
+    fprintf(f, ",\"propagations\":%" PRIu64 ",\"propagations_per_sec\":", m.propagations);
+    printDouble(f, m.propagations * rate);
+    fprintf(f, ",\"nodes\":%" PRIu64 ",\"nodes_per_sec\":", m.nodes);
+    printDouble(f, m.nodes * rate);
+    fprintf(f, ",\"hard\":%" PRIu64 ",\"cache_hit_rate\":", m.hard);
+    if (m.cacheHitRate < 0) fprintf(f, "null");
+    else printDouble(f, m.cacheHitRate);
+    fprintf(f, ",\"peak_rss_mb\":");
+    printDouble(f, m.peakRss);
+    fprintf(f, "}");
+}
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+Measure benchEA(const std::string &name, Solver &S, const std::vector<int> &pool, int size, int iterations, int seed) {
+    Measure m;
+    m.instance = name;
+    m.workload = "ea";
+    m.size = size;
+
+    EvolutionaryAlgorithm ea(S, seed);
+    std::ostream silent(nullptr);
+    ea.out = &silent;
+    auto start = std::chrono::steady_clock::now();
+    ea.run(iterations, size, pool, silent, seed);
+    m.seconds = since(start);
+
+    EvolutionaryAlgorithm::WorkCounters work = ea.workCounters();
+    m.evaluations = ea.cache_misses;
+    m.propagations = work.propagations;
+    m.nodes = work.nodes;
+    m.hard = ea.lastFitness.hard;
+    int lookups = ea.cache_hits + ea.cache_misses;
+    m.cacheHitRate = lookups > 0 ? (double)ea.cache_hits / lookups : 0;
+    m.peakRss = peakRssMB();
+    return m;
+}
+
+// Walks 'backdoors' with the cube tree ('tree') or by enumerating all cubes ('propcheck')
+Measure benchWalk(const std::string &name, Solver &S, const std::vector<std::vector<int>> &backdoors, bool tree) {
+    Measure m;
+    m.instance = name;
+    m.workload = tree ? "tree" : "propcheck";
+    m.size = backdoors.empty() ? 0 : backdoors.front().size();
+
+    uint64_t propagations = S.propagations;
+    uint64_t nodes = S.tree_nodes;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &backdoor : backdoors) {
+        uint64_t hard = 0;
+        if (tree) S.gen_all_valid_assumptions_tree(backdoor, hard, Solver::CubeSink());
+        else S.gen_all_valid_assumptions_propcheck(backdoor, hard, Solver::CubeSink());
+        m.hard += hard;
+    }
+    m.seconds = since(start);
+    m.evaluations = backdoors.size();
+    m.propagations = S.propagations - propagations;
+    m.nodes = S.tree_nodes - nodes;
+    m.peakRss = peakRssMB();
+    return m;
+}
+
+}  // namespace
+
+//=================================================================================================
+// Main:
+
+int main(int argc, char **argv) {
+    try {
+        setUsageHelp("USAGE: %s [options] <suite-file> [<json-output-file>]\n\n"
+                     "  where each line of the suite file is '<DIMACS file> <backdoor size>'.\n");
+
+        IntOption seed("BENCH", "seed", "Seed of the EA runs and of the random backdoors.\n", 42, IntRange(0, INT32_MAX));
+        IntOption iterations("BENCH", "iters", "EA iterations per formula (0 = no EA workload).\n", 2000, IntRange(0, INT32_MAX));
+        IntOption walks("BENCH", "walks", "Random backdoors walked per formula (0 = no walk workloads).\n", 100, IntRange(0, INT32_MAX));
+        BoolOption propcheck("BENCH", "propcheck", "Also walk the backdoors with 'gen_all_valid_assumptions_propcheck'.\n", true);
+
+        parseOptions(argc, argv, true);
+        if (argc < 2) {
+            fprintf(stderr, "ERROR! Missing suite file.\n");
+            return 1;
+        }
+
+        std::vector<Entry> entries;
+        if (!readSuite(argv[1], entries)) {
+            fprintf(stderr, "ERROR! Could not read suite file: %s\n", argv[1]);
+            return 1;
+        }
+
+        std::vector<Measure> measures;
+        for (const Entry &entry : entries) {
+            Solver S;
+            S.verbosity = 0;
+            if (!loadFormula(entry.path, S)) {
+                fprintf(stderr, "ERROR! Could not open file: %s\n", entry.path.c_str());
+                return 1;
+            }
+            const std::string &name = entry.name;
+            std::vector<int> pool = makePool(S);
+            if (!S.okay() || (int)pool.size() < entry.size) {
+                fprintf(stderr, "Skipping %s: %s\n", name.c_str(), S.okay() ? "pool smaller than the backdoor" : "solved by unit propagation");
+                continue;
+            }
+
+            if (iterations > 0) {
+                measures.push_back(benchEA(name, S, pool, entry.size, iterations, seed));
+                fprintf(stderr, "%-36s ea         %8.3f s\n", name.c_str(), measures.back().seconds);
+            }
+            if (walks > 0) {
+                std::mt19937 gen(seed);
+                std::vector<std::vector<int>> backdoors;
+                std::vector<int> vars = pool;
+                for (int i = 0; i < walks; ++i) {
+                    // Partial Fisher-Yates shuffle, independent of the standard library:
+                    for (int j = 0; j < entry.size; ++j) {
+                        size_t k = j + gen() % (vars.size() - j);
+                        std::swap(vars[j], vars[k]);
+                    }
+                    backdoors.emplace_back(vars.begin(), vars.begin() + entry.size);
+                }
+                measures.push_back(benchWalk(name, S, backdoors, true));
+                fprintf(stderr, "%-36s tree       %8.3f s\n", name.c_str(), measures.back().seconds);
+                if (propcheck) {
+                    measures.push_back(benchWalk(name, S, backdoors, false));
+                    fprintf(stderr, "%-36s propcheck  %8.3f s\n", name.c_str(), measures.back().seconds);
+                }
+            }
+        }
+
+        FILE *res = argc >= 3 ? fopen(argv[2], "wb") : stdout;
+        if (res == NULL) {
+            fprintf(stderr, "ERROR! Could not open file: %s\n", argv[2]);
+            return 1;
+        }
+        fprintf(res, "{\n  \"seed\":%d,\n  \"iterations\":%d,\n  \"walks\":%d,\n  \"benchmarks\":[\n", (int)seed, (int)iterations, (int)walks);
+        for (size_t i = 0; i < measures.size(); ++i) {
+            printMeasure(res, measures[i]);
+            fprintf(res, i + 1 < measures.size() ? ",\n" : "\n");
+        }
+        fprintf(res, "  ],\n  \"peak_rss_mb\":");
+        printDouble(res, peakRssMB());
+        fprintf(res, "\n}\n");
+        if (res != stdout) fclose(res);
+        return 0;
+    } catch (OutOfMemoryException &) {
+        fprintf(stderr, "ERROR! Out of memory\n");
+        return 1;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef BACKDOORKEY_H
+#define BACKDOORKEY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace Minisat {
+
+// Zobrist value of a variable. The hash of a set of variables is the XOR of their values, so it
+// does not depend on the order and can be updated incrementally when one variable is swapped.
+inline uint64_t zobrist(int var) {
+    // splitmix64 finalizer
+    uint64_t z = static_cast<uint64_t>(var) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Non-owning view of a set of distinct variables stored in arbitrary order, with precomputed
+// hash. Entries equal to -1 (holes) are ignored.
+struct BackdoorRef {
+    const int *data;
+    size_t size;     // number of entries, including holes
+    int count;       // number of variables
+    uint64_t hash;   // XOR of 'zobrist' of the variables
+};
+
+// Compact owning key: the sorted variables are kept inline up to 'Inline' of them, so the keys
+// of typical backdoors are stored without any heap allocation.
+class BackdoorKey {
+   public:
+    static constexpr int Inline = 14;
+
+    BackdoorKey() = default;
+
+    explicit BackdoorKey(const BackdoorRef &ref) : key_hash(ref.hash), count(ref.count) {
+        int *out = count <= Inline ? small : (large.reset(new int[count]), large.get());
+        int k = 0;
+        for (size_t i = 0; i < ref.size; ++i) {
+            if (ref.data[i] != -1) out[k++] = ref.data[i];
+        }
+        std::sort(out, out + count);
+    }
+
+    BackdoorKey(const BackdoorKey &other) : key_hash(other.key_hash), count(other.count) {
+        if (count > Inline) large.reset(new int[count]);
+        std::memcpy(vars(), other.vars(), count * sizeof(int));
+    }
+
+    BackdoorKey(BackdoorKey &&other) noexcept = default;
+
+    BackdoorKey &operator=(BackdoorKey other) noexcept {
+        key_hash = other.key_hash;
+        count = other.count;
+        std::memcpy(small, other.small, sizeof(small));
+        large = std::move(other.large);
+        return *this;
+    }
+
+    [[nodiscard]] uint64_t hash() const { return key_hash; }
+    [[nodiscard]] int size() const { return count; }
+    [[nodiscard]] const int *begin() const { return vars(); }
+    [[nodiscard]] const int *end() const { return vars() + count; }
+
+    // Heap memory owned by the key (zero for inline keys).
+    [[nodiscard]] size_t heapBytes() const { return count > Inline ? count * sizeof(int) : 0; }
+
+    // Exact set equality, without allocating or sorting 'ref'.
+    [[nodiscard]] bool matches(const BackdoorRef &ref) const {
+        if (ref.hash != key_hash || ref.count != count) return false;
+        for (size_t i = 0; i < ref.size; ++i) {
+            if (ref.data[i] != -1 && !std::binary_search(begin(), end(), ref.data[i])) return false;
+        }
+        return true;
+    }
+
+   private:
+    [[nodiscard]] const int *vars() const { return count <= Inline ? small : large.get(); }
+    int *vars() { return count <= Inline ? small : large.get(); }
+
+    uint64_t key_hash = 0;
+    int count = 0;
+    int small[Inline] = {};
+    std::unique_ptr<int[]> large;
+};
+
+}  // namespace Minisat
+
+#endif
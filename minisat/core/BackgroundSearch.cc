@@ -0,0 +1,170 @@
+#include "minisat/core/BackgroundSearch.h"
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+#include "minisat/core/EA.h"
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+BackgroundSearch::BackgroundSearch(Config config) : config(std::move(config)) {
+    worker = std::thread([this] { loop(); });
+}
+
+BackgroundSearch::~BackgroundSearch() {
+    stop();
+    delete pending.exchange(nullptr);
+    delete result.exchange(nullptr);
+}
+
+void BackgroundSearch::stop() {
+    stopping = true;
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+bool BackgroundSearch::due() const {
+    return std::chrono::steady_clock::now() >= next_snapshot;
+}
+
+void BackgroundSearch::submit(const Solver &solver) {
+    auto *snapshot = new Snapshot;
+    CnfData &cnf = snapshot->cnf;
+    cnf.headerVars = cnf.maxVar = solver.nVars();
+    int numClauses = solver.exportClauses(cnf.lits, false);
+    snapshot->learntsOffset = cnf.lits.size();
+    snapshot->numLearnts = solver.exportClauses(cnf.lits, true);
+    cnf.headerClauses = cnf.numClauses = numClauses + snapshot->numLearnts;
+
+    // A snapshot the worker has not taken yet is outdated now:
+    delete pending.exchange(snapshot);
+    wake.notify_one();
+    next_snapshot = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                            std::chrono::duration<double>(config.interval));
+}
+
+std::unique_ptr<BackdoorResult> BackgroundSearch::take() {
+    return std::unique_ptr<BackdoorResult>(result.exchange(nullptr));
+}
+
+BackdoorResult BackgroundSearch::best() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return best_result;
+}
+
+void BackgroundSearch::publish(BackdoorResult found) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        best_result = found;
+    }
+    delete result.exchange(new BackdoorResult(std::move(found)));
+}
+
+void BackgroundSearch::loop() {
+    int phase = 0;
+    while (!stopping) {
+        std::unique_ptr<Snapshot> snapshot(pending.exchange(nullptr));
+        if (!snapshot) {
+            // The solver does not take the lock to notify, so a wake-up may be missed; hence the timeout
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(100), [&] { return stopping || pending.load() != nullptr; });
+            continue;
+        }
+        runPhase(++phase, *snapshot);
+    }
+}
+
+void BackgroundSearch::runPhase(int phase, const Snapshot &snapshot) {
+    Solver base;
+    addToSolver(snapshot.cnf, base);
+    if (!base.simplify()) return;  // unsatisfiable at the top level: the solver finds out by itself
+
+    // Unassigned variables occurring in the simplified clauses:
+    std::vector<bool> occurs(base.nVars(), false);
+    for (ClauseIterator it = base.clausesBegin(); it != base.clausesEnd(); ++it) {
+        const Clause &c = *it;
+        for (int i = 0; i < c.size(); ++i) occurs[var(c[i])] = true;
+    }
+    std::vector<int> pool;
+    for (Var v = 0; v < base.nVars(); ++v) {
+        if (occurs[v] && base.value(v) == l_Undef) pool.push_back(v);
+    }
+    if (pool.empty()) return;
+    num_phases++;
+
+    if (config.dumpLearnts) {
+        std::ofstream learnts("learnts-" + std::to_string(phase) + ".txt", std::ios::out | std::ios::trunc);
+        for (size_t i = snapshot.learntsOffset; i < snapshot.cnf.lits.size(); ++i) {
+            int lit = snapshot.cnf.lits[i];
+            learnts << lit << (lit == 0 ? '\n' : ' ');
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (config.output) {
+            RunResult separator;
+            separator.kind = RunResult::Kind::Phase;
+            separator.run = phase;
+            config.output->write(config.outputFormat, separator);
+        }
+        if (config.verbose) {
+            std::cout << "Background phase " << phase << ": " << snapshot.numLearnts << " learnts, pool size "
+                      << pool.size() << std::endl;
+        }
+    }
+
+    auto usage = std::make_shared<BudgetUsage>();
+    auto cache = std::make_shared<FitnessCache>(config.cacheBytes);
+    std::atomic<int> next_run(0);
+    std::mutex best_mutex;
+    std::optional<Fitness> phase_best;
+    auto finished = [&] {
+        return stopping || pending.load() != nullptr || usage->check(config.phaseBudget) != StopReason::None;
+    };
+
+    auto work = [&](Solver &solver) {
+        EvolutionaryAlgorithm ea(solver, -1, cache);
+        if (config.configure) config.configure(ea);
+        ea.jobBudget = config.phaseBudget;
+        ea.jobUsage = usage;
+        ea.cancel = &stopping;
+        for (int r = next_run++; r < config.runs && !finished(); r = next_run++) {
+            std::ostringstream log, record;
+            ea.out = &log;
+            ea.runNumber = r + 1;
+            Instance instance = ea.run(config.iterations, config.instanceSize, pool, record,
+                                       EvolutionaryAlgorithm::runSeed(config.seed, (phase - 1) * config.runs + r + 1));
+            if (ea.stopReason == StopReason::Interrupted) break;
+            num_runs++;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (config.output) config.output->write(record.str());
+                if (config.verbose) std::cout << log.str() << std::flush;
+            }
+            std::lock_guard<std::mutex> lock(best_mutex);
+            if (!phase_best || ea.lastFitness < *phase_best) {
+                phase_best = ea.lastFitness;
+                publish(BackdoorResult{phase, ea.lastFitness, instance.getVariables()});
+            }
+        }
+    };
+
+    if (config.threads <= 1) {
+        work(base);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < config.threads; ++t) {
+        threads.emplace_back([&] {
+            Solver copy;
+            base.copyTo(copy);
+            work(copy);
+        });
+    }
+    for (auto &thread : threads) thread.join();
+}
+
+}  // namespace Minisat
@@ -0,0 +1,102 @@
+#ifndef BACKGROUNDSEARCH_H
+#define BACKGROUNDSEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "minisat/core/Budget.h"
+#include "minisat/core/CnfLoader.h"
+#include "minisat/core/Fitness.h"
+#include "minisat/core/ResultWriter.h"
+
+namespace Minisat {
+
+class EvolutionaryAlgorithm;
+class Solver;
+
+// A backdoor found in the background: 0-based variables and their fitness on the snapshot of 'phase'
+struct BackdoorResult {
+    int phase = 0;
+    Fitness fitness{};
+    std::vector<int> vars;
+};
+
+// Backdoor search alongside CDCL. The solver hands over snapshots of its top-level units, problem
+// clauses and learnt clauses; a worker thread builds a solver from the latest one and runs EA runs
+// on it (a "phase") while the search goes on. Snapshots and results are passed through atomic
+// pointers, so neither side ever waits for the other: a newer snapshot replaces one not yet taken,
+// and a newer result replaces one not yet collected.
+class BackgroundSearch {
+   public:
+    struct Config {
+        double interval = 300;   // seconds between snapshots (the first one is taken at once)
+        int runs = 100;          // EA runs per phase
+        int iterations = 1000;   // per run
+        int instanceSize = 10;
+        int threads = 1;         // workers running the runs of a phase
+        int seed = -1;
+        Budget phaseBudget;    // limits of each phase, as the job budget of its runs
+        size_t cacheBytes = 0;    // fitness cache per phase, 0 = unbounded
+        bool dumpLearnts = false;  // write the learnts of each snapshot to 'learnts-<phase>.txt'
+        bool verbose = false;      // EA progress log on stdout
+        std::shared_ptr<ResultWriter> output;  // the best backdoor of every run is appended (optional)
+        ResultFormat outputFormat = ResultFormat::Text;  // of the phase separators in 'output'
+        std::function<void(EvolutionaryAlgorithm &)> configure;  // applied to every EA before its runs
+    };
+
+    explicit BackgroundSearch(Config config);
+    ~BackgroundSearch();
+
+    BackgroundSearch(const BackgroundSearch &) = delete;
+    BackgroundSearch &operator=(const BackgroundSearch &) = delete;
+
+    // Solver side: whether a snapshot is due, and handing it over (at decision level 0)
+    [[nodiscard]] bool due() const;
+    void submit(const Solver &solver);
+
+    // Solver side: the best backdoor found since the last call, if any
+    std::unique_ptr<BackdoorResult> take();
+
+    // Stops the runs in progress and joins the worker
+    void stop();
+
+    [[nodiscard]] int phases() const { return num_phases; }
+    [[nodiscard]] int runs() const { return num_runs; }
+    // The best result of the latest phase that found one
+    [[nodiscard]] BackdoorResult best() const;
+
+   private:
+    struct Snapshot {
+        CnfData cnf;
+        int numLearnts = 0;
+        size_t learntsOffset = 0;  // in 'cnf.lits'
+    };
+
+    void loop();
+    void runPhase(int phase, const Snapshot &snapshot);
+    void publish(BackdoorResult result);
+
+    Config config;
+    std::chrono::steady_clock::time_point next_snapshot;
+    std::atomic<Snapshot *> pending{nullptr};
+    std::atomic<BackdoorResult *> result{nullptr};
+    std::atomic<bool> stopping{false};
+    std::atomic<int> num_phases{0};
+    std::atomic<int> num_runs{0};
+
+    mutable std::mutex mutex;  // guards 'best_result' and the verbose log, and is used for waking the worker
+    std::condition_variable wake;
+    BackdoorResult best_result;
+    std::thread worker;
+};
+
+}  // namespace Minisat
+
+#endif
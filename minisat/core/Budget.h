@@ -0,0 +1,74 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Minisat {
+
+// Limits of an EA run or of a whole job; 0 means unlimited
+struct Budget {
+    double seconds = 0;        // wall-clock time
+    uint64_t evaluations = 0;  // fitness evaluations that missed the cache
+    uint64_t propagations = 0;
+    int stagnation = 0;        // iterations without improvement of the best fitness (runs only)
+};
+
+// Why an EA run stopped
+enum class StopReason {
+    None,
+    Iterations,
+    Stagnation,
+    Time,
+    Evaluations,
+    Propagations,
+    JobTime,
+    JobEvaluations,
+    JobPropagations,
+    Interrupted,
+};
+
+inline const char *toString(StopReason reason) {
+    switch (reason) {
+        case StopReason::None: return "none";
+        case StopReason::Iterations: return "iteration limit";
+        case StopReason::Stagnation: return "stagnation limit";
+        case StopReason::Time: return "time limit";
+        case StopReason::Evaluations: return "evaluation limit";
+        case StopReason::Propagations: return "propagation limit";
+        case StopReason::JobTime: return "job time limit";
+        case StopReason::JobEvaluations: return "job evaluation limit";
+        case StopReason::JobPropagations: return "job propagation limit";
+        case StopReason::Interrupted: return "interrupted";
+    }
+    return "unknown";
+}
+
+// Whether no further runs of the job should start
+inline bool isJobLimit(StopReason reason) {
+    return reason == StopReason::JobTime || reason == StopReason::JobEvaluations || reason == StopReason::JobPropagations;
+}
+
+// Usage of a job budget, shared by all its runs and workers
+struct BudgetUsage {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::atomic<uint64_t> evaluations{0};
+    std::atomic<uint64_t> propagations{0};
+
+    [[nodiscard]] double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // The first job limit of 'budget' that is reached, or 'None'
+    [[nodiscard]] StopReason check(const Budget &budget) const {
+        if (budget.seconds > 0 && seconds() >= budget.seconds) return StopReason::JobTime;
+        if (budget.evaluations > 0 && evaluations >= budget.evaluations) return StopReason::JobEvaluations;
+        if (budget.propagations > 0 && propagations >= budget.propagations) return StopReason::JobPropagations;
+        return StopReason::None;
+    }
+};
+
+}  // namespace Minisat
+
+#endif
@@ -0,0 +1,248 @@
+#include "minisat/core/Checkpoint.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace Minisat {
+
+namespace {
+
+constexpr int Version = 3;
+
+int64_t now() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+bool fileSize(const std::string &path, uint64_t &size) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = st.st_size;
+    return true;
+}
+
+// Doubles are written as hexadecimal floats, so they are read back exactly
+void writeFitness(std::ostream &os, const Fitness &f) {
+    os << std::hexfloat << f.fitness << ' ' << f.rho << ' ' << f.error << std::defaultfloat
+       << ' ' << f.hard << ' ' << f.lowerBound;
+}
+
+void writeInts(std::ostream &os, const std::vector<int> &values) {
+    os << ' ' << values.size();
+    for (int x : values) os << ' ' << x;
+}
+
+void writeInstance(std::ostream &os, const Instance &instance) {
+    writeInts(os, instance.data);
+    writeInts(os, instance.pool);
+}
+
+double readDouble(std::istream &is) {
+    std::string token;
+    is >> token;
+    return std::strtod(token.c_str(), nullptr);
+}
+
+Fitness readFitness(std::istream &is) {
+    Fitness f{};
+    f.fitness = readDouble(is);
+    f.rho = readDouble(is);
+    f.error = readDouble(is);
+    is >> f.hard >> f.lowerBound;
+    return f;
+}
+
+std::vector<int> readInts(std::istream &is) {
+    size_t n = 0;
+    is >> n;
+    std::vector<int> values(is ? n : 0);
+    for (int &x : values) is >> x;
+    return values;
+}
+
+Instance readInstance(std::istream &is) {
+    std::vector<int> data = readInts(is);
+    std::vector<int> pool = readInts(is);
+    return Instance(std::move(data), std::move(pool));
+}
+
+}  // namespace
+
+Checkpoint::Checkpoint(std::string path, uint64_t job, std::string outputPath)
+    : path(std::move(path)), job(job), outputPath(std::move(outputPath)) {}
+
+void Checkpoint::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    runs.clear();
+    num_completed = 0;
+    if (!fileSize(outputPath, output_size)) output_size = 0;
+    save();
+}
+
+bool Checkpoint::load(std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    runs.clear();
+
+    std::string tag;
+    int version = 0;
+    uint64_t saved_job = 0;
+    in >> tag >> version;
+    if (tag != "ea-checkpoint" || version != Version) {
+        error = path + " is not an EA checkpoint";
+        return false;
+    }
+    in >> tag >> std::hex >> saved_job >> std::dec;
+    if (saved_job != job) {
+        error = path + " was written for a different formula or different EA options";
+        return false;
+    }
+    in >> tag >> num_completed >> tag >> output_size;
+    while (in >> tag && tag == "run") {
+        RunState state;
+        in >> state.run >> state.started >> state.finished >> state.iteration >> state.bestIteration;
+        size_t n = 0;
+        in >> tag >> n;
+        state.counters.resize(n);
+        for (auto &c : state.counters) in >> c;
+        in >> tag >> state.gen;
+        in >> tag >> n;
+        for (size_t i = 0; i < n; ++i) {
+            state.fits.push_back(readFitness(in));
+            state.population.push_back(readInstance(in));
+        }
+        in >> tag >> n;
+        if (n > 0) {
+            state.bestFitness = readFitness(in);
+            state.best.emplace(readInstance(in));
+        }
+        in >> tag >> n;
+        state.front.resize(in ? n : 0);
+        for (ParetoFront::Point &point : state.front) {
+            in >> point.size;
+            point.fitness = readFitness(in);
+            point.vars = readInts(in);
+        }
+        in >> tag >> n;
+        in.get();
+        state.strategy.resize(n);
+        in.read(&state.strategy[0], n);
+        in >> tag >> n;
+        in.get();
+        state.record.resize(n);
+        in.read(&state.record[0], n);
+        runs[state.run] = std::move(state);
+    }
+    if (!in || tag != "end") {
+        error = path + " is damaged";
+        runs.clear();
+        return false;
+    }
+    last_save = now();
+    return true;
+}
+
+bool Checkpoint::restoreOutput() {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t size = 0;
+    if (!fileSize(outputPath, size) || size < output_size) return false;
+    return size == output_size || truncate(outputPath.c_str(), output_size) == 0;
+}
+
+int Checkpoint::completed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_completed;
+}
+
+bool Checkpoint::get(int run, RunState &state) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = runs.find(run);
+    if (it == runs.end()) return false;
+    state = it->second;
+    return true;
+}
+
+bool Checkpoint::due() const {
+    return stop || now() - last_save >= std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval).count();
+}
+
+void Checkpoint::update(const RunState &state) {
+    std::lock_guard<std::mutex> lock(mutex);
+    runs[state.run] = state;
+    save();
+}
+
+void Checkpoint::complete(int run, const RunState *next) {
+    std::lock_guard<std::mutex> lock(mutex);
+    runs.erase(run);
+    num_completed = run;
+    if (!fileSize(outputPath, output_size)) output_size = 0;
+    if (next) runs[next->run] = *next;
+    save();
+}
+
+void Checkpoint::save() {
+    std::ostringstream os;
+    os << "ea-checkpoint " << Version << '\n'
+       << "job " << std::hex << job << std::dec << '\n'
+       << "completed " << num_completed << '\n'
+       << "output " << output_size << '\n';
+    for (const auto &entry : runs) {
+        const RunState &state = entry.second;
+        os << "run " << state.run << ' ' << state.started << ' ' << state.finished << ' '
+           << state.iteration << ' ' << state.bestIteration << '\n';
+        os << "counters " << state.counters.size();
+        for (int64_t c : state.counters) os << ' ' << c;
+        os << "\ngen " << state.gen << '\n';
+        os << "population " << state.population.size() << '\n';
+        for (size_t i = 0; i < state.population.size(); ++i) {
+            writeFitness(os, state.fits[i]);
+            writeInstance(os, state.population[i]);
+            os << '\n';
+        }
+        os << "best " << state.best.has_value();
+        if (state.best) {
+            os << ' ';
+            writeFitness(os, state.bestFitness);
+            writeInstance(os, *state.best);
+        }
+        os << "\nfront " << state.front.size() << '\n';
+        for (const ParetoFront::Point &point : state.front) {
+            os << point.size << ' ';
+            writeFitness(os, point.fitness);
+            writeInts(os, point.vars);
+            os << '\n';
+        }
+        os << "strategy " << state.strategy.size() << '\n' << state.strategy << '\n';
+        os << "record " << state.record.size() << '\n' << state.record << '\n';
+    }
+    os << "end\n";
+
+    std::string tmp = path + ".tmp." + std::to_string(getpid());
+    std::ofstream out(tmp, std::ios::trunc);
+    out << os.str();
+    out.close();
+    if (!out || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        fprintf(stderr, "WARNING! Could not write checkpoint: %s\n", path.c_str());
+    }
+    last_save = now();
+}
+
+uint64_t Checkpoint::fingerprint(const std::vector<uint64_t> &values) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (uint64_t value : values) {
+        for (int i = 0; i < 8; ++i) h = (h ^ ((value >> (8 * i)) & 0xFF)) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+}  // namespace Minisat
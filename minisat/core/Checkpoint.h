@@ -0,0 +1,85 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "minisat/core/Fitness.h"
+#include "minisat/core/Instance.h"
+#include "minisat/core/ParetoFront.h"
+
+namespace Minisat {
+
+// Saved state of one EA run
+struct RunState {
+    int run = 0;             // 1-based run number
+    bool started = false;    // false: only 'gen' and 'counters', the state before the run
+    bool finished = false;   // done, but its record is not in the output file yet
+    int iteration = 0;       // last completed iteration
+    int bestIteration = 0;
+    std::mt19937 gen;
+    std::vector<int64_t> counters;
+    std::vector<Instance> population;  // the current instance in the (1+1) EA
+    std::vector<Fitness> fits;
+    std::optional<Instance> best;
+    Fitness bestFitness{};
+    std::vector<ParetoFront::Point> front;  // size/hardness front so far (with omega)
+    std::string strategy;    // 'SearchStrategy::save' of the local search, if any
+    std::string record;      // the best backdoor line(s), if 'finished'
+};
+
+// Checkpoint of an EA job: the number of runs whose records are in the output file, the size
+// of that file, and the state of the runs in progress. Every save writes a temporary file and
+// renames it, so a checkpoint is never partial. A fingerprint of the job (formula, pool and the
+// options affecting the search) guards against resuming a different job.
+class Checkpoint {
+   public:
+    Checkpoint(std::string path, uint64_t job, std::string outputPath);
+
+    // Fresh job: no completed runs, the output file as it is now.
+    void start();
+    // Reads the checkpoint file; on failure 'error' says why.
+    bool load(std::string &error);
+    // Cuts the output file back to its size at the checkpoint; false if it is shorter.
+    bool restoreOutput();
+
+    [[nodiscard]] int completed() const;
+    bool get(int run, RunState &state) const;
+    // Whether to save: 'interval' has passed since the last save, or stopping was requested
+    [[nodiscard]] bool due() const;
+    void update(const RunState &state);
+    // The record of 'run' was appended to the output file; 'next' is the state to start the next run from.
+    void complete(int run, const RunState *next = nullptr);
+
+    // Async-signal-safe request to save and stop
+    void interrupt() { stop = true; }
+    [[nodiscard]] bool interrupted() const { return stop; }
+
+    static uint64_t fingerprint(const std::vector<uint64_t> &values);
+
+    std::chrono::seconds interval{60};
+
+   private:
+    void save();  // with 'mutex' held
+
+    std::string path;
+    uint64_t job;
+    std::string outputPath;
+    mutable std::mutex mutex;
+    int num_completed = 0;
+    uint64_t output_size = 0;
+    std::map<int, RunState> runs;
+    std::atomic<int64_t> last_save{0};
+    std::atomic<bool> stop{false};
+};
+
+}  // namespace Minisat
+
+#endif
@@ -0,0 +1,142 @@
+#include "minisat/core/ClauseSet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+
+namespace Minisat {
+
+namespace {
+
+std::vector<int> sortedKey(const Clause &c) {
+    std::vector<int> key(c.size());
+    for (int i = 0; i < c.size(); ++i) key[i] = toInt(c[i]);
+    std::sort(key.begin(), key.end());
+    return key;
+}
+
+}  // namespace
+
+lbool ClauseSet::learn(uint64_t conflicts) {
+    Solver copy;
+    formula.copyTo(copy);
+    copy.verbosity = 0;
+
+    // LBD of the learnt clauses by their sorted literals, as the database reorders them
+    std::map<std::vector<int>, int> lbds;
+    copy.learnt_export_size = INT32_MAX;
+    copy.learnt_export = [&](const vec<Lit> &c, int lbd) {
+        if (c.size() == 1) {
+            units.push_back(c[0]);
+            return;
+        }
+        std::vector<int> key(c.size());
+        for (int i = 0; i < c.size(); ++i) key[i] = toInt(c[i]);
+        std::sort(key.begin(), key.end());
+        lbds[key] = lbd;
+    };
+    copy.setConfBudget(conflicts);
+    vec<Lit> none;
+    lbool result = copy.solveLimited(none);
+    copy.learnt_export = nullptr;
+
+    copy.forEachLearnt([&](const Clause &c) {
+        LearntClause learnt;
+        for (int i = 0; i < c.size(); ++i) learnt.lits.push_back(c[i]);
+        auto it = lbds.find(sortedKey(c));
+        learnt.lbd = it != lbds.end() ? it->second : c.size();
+        learnt.activity = c.activity();
+        learnt.measured = true;
+        clauses.push_back(std::move(learnt));
+    });
+    return result;
+}
+
+bool ClauseSet::read(const std::string &path, std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    LearntClause clause;
+    for (int number = 1; std::getline(in, line); ++number) {
+        const char *p = line.c_str();
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == 'c' || *p == 'p' || *p == '\0') continue;
+        for (;;) {
+            char *end;
+            long lit = std::strtol(p, &end, 10);
+            if (end == p) {
+                while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+                if (*p == '\0') break;
+                error = path + ":" + std::to_string(number) + ": unexpected character '" + *p + "'";
+                return false;
+            }
+            p = end;
+            if (lit == 0) {
+                clauses.push_back(std::move(clause));
+                clause = LearntClause();
+                continue;
+            }
+            long v = std::labs(lit) - 1;
+            if (v >= formula.nVars()) {
+                error = path + ":" + std::to_string(number) + ": variable " + std::to_string(v + 1) + " is not in the formula";
+                return false;
+            }
+            clause.lits.push_back(mkLit(v, lit < 0));
+        }
+    }
+    if (!clause.lits.empty()) {
+        error = path + ": last clause is not terminated by 0";
+        return false;
+    }
+    return true;
+}
+
+size_t ClauseSet::filter(const LearntFilter &filter) {
+    // The activity of the least active learnt clause kept:
+    double threshold = -HUGE_VAL;
+    if (filter.activity < 1) {
+        std::vector<double> activities;
+        for (const auto &c : clauses) {
+            if (c.measured) activities.push_back(c.activity);
+        }
+        size_t keep = std::ceil(filter.activity * activities.size());
+        if (keep == 0) {
+            threshold = HUGE_VAL;
+        } else if (keep < activities.size()) {
+            std::nth_element(activities.begin(), activities.begin() + (keep - 1), activities.end(), std::greater<double>());
+            threshold = activities[keep - 1];
+        }
+    }
+
+    std::vector<LearntClause> kept;
+    for (auto &c : clauses) {
+        if (filter.maxSize > 0 && c.lits.size() > (size_t)filter.maxSize) continue;
+        if (c.measured && filter.maxLbd > 0 && c.lbd > filter.maxLbd) continue;
+        if (c.measured && c.activity < threshold) continue;
+        kept.push_back(std::move(c));
+    }
+    clauses.swap(kept);
+    return clauses.size();
+}
+
+bool ClauseSet::build(Solver &out) const {
+    formula.copyTo(out);
+    for (Lit p : units) {
+        if (!out.addClause(p)) return false;
+    }
+    vec<Lit> lits;
+    for (const auto &c : clauses) {
+        lits.clear();
+        for (Lit p : c.lits) lits.push(p);
+        if (!out.addClause(lits)) return false;
+    }
+    return out.simplify();
+}
+
+}  // namespace Minisat
@@ -0,0 +1,62 @@
+#ifndef CLAUSESET_H
+#define CLAUSESET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+// A learnt clause with the measures it is filtered by. Clauses read from files have neither
+// (lbd = 0, activity = 0) and are filtered by their size only.
+struct LearntClause {
+    std::vector<Lit> lits;
+    int lbd = 0;
+    double activity = 0;
+    bool measured = false;  // learnt by 'ClauseSet::learn'
+};
+
+struct LearntFilter {
+    int maxSize = 0;        // 0 = unlimited
+    int maxLbd = 0;         // 0 = unlimited
+    double activity = 1;    // fraction of the most active learnt clauses kept
+};
+
+// The clause set backdoors are evaluated against: the top-level units and problem clauses of a
+// formula, plus selected learnt clauses. Learnt clauses are added to the evaluation solver as
+// ordinary clauses; they are implied by the formula, so fitness stays a property of the same
+// formula, while more cubes are refuted by propagation alone.
+class ClauseSet {
+   public:
+    explicit ClauseSet(const Solver &formula) : formula(formula) {}
+
+    // Runs CDCL on a copy of the formula for at most 'conflicts' conflicts and collects the learnt
+    // units and the learnt clauses still in its database, with their LBD and activity.
+    // Returns the result of the run.
+    lbool learn(uint64_t conflicts);
+
+    // Reads clauses given as DIMACS literals, each terminated by 0, e.g. learnts dumped by an earlier
+    // solve; comment and header lines are skipped.
+    bool read(const std::string &path, std::string &error);
+
+    // Keeps the learnt clauses passing 'filter'; returns their number. Learnt units are always kept.
+    size_t filter(const LearntFilter &filter);
+
+    // Writes the formula and the kept learnt clauses into the empty solver 'out'. Returns false if
+    // 'out' is found unsatisfiable.
+    bool build(Solver &out) const;
+
+    [[nodiscard]] size_t numUnits() const { return units.size(); }
+    [[nodiscard]] size_t numClauses() const { return clauses.size(); }
+
+   private:
+    const Solver &formula;
+    std::vector<Lit> units;
+    std::vector<LearntClause> clauses;
+};
+
+}  // namespace Minisat
+
+#endif
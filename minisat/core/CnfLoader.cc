@@ -0,0 +1,238 @@
+#include "minisat/core/CnfLoader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "minisat/utils/ThreadPool.h"
+
+namespace Minisat {
+
+namespace {
+
+struct Chunk {
+    std::vector<int> lits;
+    int maxVar = 0;
+    int numClauses = 0;
+    bool header = false;
+    int headerVars = 0;
+    int headerClauses = 0;
+    int error = 0;  // offending character of a parse error (EOF at the end of the input)
+    bool failed = false;
+};
+
+inline bool isSpace(char c) { return (c >= 9 && c <= 13) || c == 32; }
+
+// Same rules as 'parseInt' in ParseUtils.h; false on a parse error
+bool parseInt(const char *&p, const char *end, int &value, int &error) {
+    while (p < end && isSpace(*p)) ++p;
+    bool neg = false;
+    if (p < end && *p == '-') neg = true, ++p;
+    else if (p < end && *p == '+') ++p;
+    if (p >= end || *p < '0' || *p > '9') {
+        error = p < end ? static_cast<unsigned char>(*p) : EOF;
+        return false;
+    }
+    int v = 0;
+    while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+    value = neg ? -v : v;
+    return true;
+}
+
+// Tokenizes [p, end), which starts at the beginning of a line
+void tokenize(const char *p, const char *end, Chunk &out) {
+    static const char header[] = "p cnf";
+    for (;;) {
+        while (p < end && isSpace(*p)) ++p;
+        if (p >= end) return;
+        if (*p == 'c') {
+            const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            p = eol ? eol + 1 : end;
+        } else if (*p == 'p') {
+            size_t n = sizeof(header) - 1;
+            if (static_cast<size_t>(end - p) < n || std::memcmp(p, header, n) != 0) {
+                const char *q = p;
+                for (size_t k = 0; k < n && q < end && *q == header[k]; ++k) ++q;
+                out.error = q < end ? static_cast<unsigned char>(*q) : EOF;
+                out.failed = true;
+                return;
+            }
+            p += n;
+            if (!parseInt(p, end, out.headerVars, out.error) || !parseInt(p, end, out.headerClauses, out.error)) {
+                out.failed = true;
+                return;
+            }
+            out.header = true;
+        } else {
+            int lit;
+            if (!parseInt(p, end, lit, out.error)) {
+                out.failed = true;
+                return;
+            }
+            out.lits.push_back(lit);
+            if (lit == 0) out.numClauses++;
+            else out.maxVar = std::max(out.maxVar, std::abs(lit));
+        }
+    }
+}
+
+constexpr char CacheMagic[8] = {'M', 'S', 'C', 'N', 'F', '\x01', '\0', '\0'};
+
+struct CacheHeader {
+    char magic[8];
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    int64_t sourceMtimeNsec;
+    int32_t headerVars;
+    int32_t headerClauses;
+    int32_t maxVar;
+    int32_t numClauses;
+    uint64_t numLits;
+};
+
+bool sourceStat(const char *path, CacheHeader &header) {
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+    header.sourceSize = st.st_size;
+    header.sourceMtime = st.st_mtim.tv_sec;
+    header.sourceMtimeNsec = st.st_mtim.tv_nsec;
+    return true;
+}
+
+}  // namespace
+
+bool readDimacsMapped(const char *path, int numThreads, CnfData &cnf) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    const char *data = nullptr;
+    if (size > 0) {
+        void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(map, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(map);
+    }
+    close(fd);
+
+    // Chunk boundaries, moved forward to line starts:
+    numThreads = std::max(1, numThreads);
+    int numChunks = size < (1 << 20) ? 1 : numThreads;
+    std::vector<size_t> bounds{0};
+    for (int i = 1; i < numChunks; ++i) {
+        size_t b = std::max(bounds.back(), size * i / numChunks);
+        const char *eol = b < size ? static_cast<const char *>(std::memchr(data + b, '\n', size - b)) : nullptr;
+        bounds.push_back(eol ? eol - data + 1 : size);
+    }
+    bounds.push_back(size);
+
+    std::vector<Chunk> chunks(numChunks);
+    auto parse = [&](int, int i) { tokenize(data + bounds[i], data + bounds[i + 1], chunks[i]); };
+    if (numChunks == 1) {
+        parse(0, 0);
+    } else {
+        ThreadPool pool(numChunks);
+        pool.parallelFor(numChunks, parse);
+    }
+    if (data) munmap(const_cast<char *>(data), size);
+
+    size_t total = 0;
+    for (const Chunk &chunk : chunks) {
+        if (chunk.failed) printf("PARSE ERROR! Unexpected char: %c\n", chunk.error), exit(3);
+        total += chunk.lits.size();
+    }
+
+    cnf = CnfData();
+    cnf.lits.reserve(total);
+    for (const Chunk &chunk : chunks) {
+        if (chunk.header) {
+            cnf.headerVars = chunk.headerVars;
+            cnf.headerClauses = chunk.headerClauses;
+        }
+        cnf.maxVar = std::max(cnf.maxVar, chunk.maxVar);
+        cnf.numClauses += chunk.numClauses;
+        cnf.lits.insert(cnf.lits.end(), chunk.lits.begin(), chunk.lits.end());
+    }
+    return true;
+}
+
+bool readCnfCache(const char *cachePath, const char *sourcePath, CnfData &cnf) {
+    CacheHeader source;
+    if (!sourceStat(sourcePath, source)) return false;
+    FILE *f = fopen(cachePath, "rb");
+    if (f == NULL) return false;
+    CacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1
+              && std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) == 0
+              && header.sourceSize == source.sourceSize
+              && header.sourceMtime == source.sourceMtime
+              && header.sourceMtimeNsec == source.sourceMtimeNsec;
+    if (ok) {
+        cnf = CnfData();
+        cnf.headerVars = header.headerVars;
+        cnf.headerClauses = header.headerClauses;
+        cnf.maxVar = header.maxVar;
+        cnf.numClauses = header.numClauses;
+        cnf.lits.resize(header.numLits);
+        ok = fread(cnf.lits.data(), sizeof(int), header.numLits, f) == header.numLits && fgetc(f) == EOF;
+    }
+    fclose(f);
+    return ok;
+}
+
+bool writeCnfCache(const char *cachePath, const char *sourcePath, const CnfData &cnf) {
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    if (!sourceStat(sourcePath, header)) return false;
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.headerVars = cnf.headerVars;
+    header.headerClauses = cnf.headerClauses;
+    header.maxVar = cnf.maxVar;
+    header.numClauses = cnf.numClauses;
+    header.numLits = cnf.lits.size();
+
+    std::string tmp = std::string(cachePath) + ".tmp." + std::to_string(getpid());
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (f == NULL) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+              && fwrite(cnf.lits.data(), sizeof(int), cnf.lits.size(), f) == cnf.lits.size();
+    ok = fclose(f) == 0 && ok;
+    if (ok) ok = rename(tmp.c_str(), cachePath) == 0;
+    if (!ok) unlink(tmp.c_str());
+    return ok;
+}
+
+void addToSolver(const CnfData &cnf, Solver &S) {
+    while (cnf.maxVar > S.nVars()) S.newVar();
+    vec<Lit> lits;
+    for (int lit : cnf.lits) {
+        if (lit == 0) {
+            S.addClause_(lits);
+            lits.clear();
+        } else {
+            lits.push(lit > 0 ? mkLit(lit - 1) : ~mkLit(-lit - 1));
+        }
+    }
+    if (lits.size() > 0) printf("PARSE ERROR! Unexpected char: %c\n", EOF), exit(3);
+
+    if (cnf.headerVars != S.nVars())
+        fprintf(stderr, "WARNING! DIMACS header mismatch: wrong number of variables.\n");
+    if (cnf.numClauses != cnf.headerClauses)
+        fprintf(stderr, "WARNING! DIMACS header mismatch: wrong number of clauses.\n");
+}
+
+}  // namespace Minisat
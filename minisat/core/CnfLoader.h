@@ -0,0 +1,36 @@
+#ifndef CNFLOADER_H
+#define CNFLOADER_H
+
+#include <vector>
+
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+// Clauses of a CNF as parsed: DIMACS literals, every clause terminated by 0.
+struct CnfData {
+    int headerVars = 0;     // as declared by the 'p cnf' line
+    int headerClauses = 0;
+    int maxVar = 0;         // largest variable used
+    int numClauses = 0;
+    std::vector<int> lits;
+};
+
+// Parses a DIMACS file through a memory map, on 'numThreads' threads. The file is cut into
+// chunks at line starts; each chunk is tokenized on its own and the literal lists are joined in
+// order, so clauses may span chunks. Returns false if the file cannot be mapped (e.g. a pipe).
+// Accepts the same input as 'parse_DIMACS' and exits with the same message on a parse error.
+bool readDimacsMapped(const char *path, int numThreads, CnfData &cnf);
+
+// Binary CNF cache: the parsed literals together with the size and modification time of the
+// source file. Reading fails if the cache is missing, damaged or older than 'sourcePath'.
+bool readCnfCache(const char *cachePath, const char *sourcePath, CnfData &cnf);
+// Written to a temporary file and renamed, so concurrent runs never see a partial cache.
+bool writeCnfCache(const char *cachePath, const char *sourcePath, const CnfData &cnf);
+
+// Adds the variables and clauses to 'S' as 'parse_DIMACS' would, including its warnings.
+void addToSolver(const CnfData &cnf, Solver &S);
+
+}  // namespace Minisat
+
+#endif
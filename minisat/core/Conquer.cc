@@ -0,0 +1,126 @@
+#include "minisat/core/Conquer.h"
+
+#include <chrono>
+#include <thread>
+
+namespace Minisat {
+
+Conquer::Conquer(const Solver &formula, int numThreads) {
+    formula.copyTo(walker);
+    for (int i = 0; i < numThreads; ++i) {
+        workers.emplace_back(new Solver);
+        formula.copyTo(*workers.back());
+        workers.back()->verbosity = 0;
+    }
+}
+
+lbool Conquer::solve(const std::vector<int> &backdoor) {
+    cubes = solved = shared = 0;
+    queue.clear();
+    pool.clear();
+    walked = satisfied = undecided = false;
+    model.clear();
+    vars = backdoor;
+    if (!walker.okay()) return l_False;
+    for (auto &worker : workers) worker->clearInterrupt();
+
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers.size(); ++w) {
+        threads.emplace_back([this, w] { work(w); });
+    }
+
+    // Once a cube is satisfiable, the rest of the walk only skips its cubes:
+    uint64_t total = 0;
+    walker.gen_all_valid_assumptions_tree(backdoor, total, [&](const std::vector<int> &signs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [&] { return queue.size() < queueSize || satisfied; });
+        if (satisfied) return;
+        CubeOutcome cube;
+        cube.index = cubes++;
+        cube.cube = signs;
+        queue.push_back(std::move(cube));
+        ready.notify_one();
+    });
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        walked = true;
+    }
+    ready.notify_all();
+
+    for (auto &thread : threads) thread.join();
+    if (satisfied) return l_True;
+    return undecided ? l_Undef : l_False;
+}
+
+void Conquer::work(int worker) {
+    Solver &solver = *workers[worker];
+    std::vector<std::vector<Lit>> exported;
+    size_t imported = 0;
+    if (shareSize > 0) {
+        solver.learnt_export_size = shareSize;
+        solver.learnt_export = [&](const vec<Lit> &clause, int) {
+            exported.emplace_back();
+            for (int i = 0; i < clause.size(); ++i) exported.back().push_back(clause[i]);
+        };
+    }
+    vec<Lit> assumptions;
+    for (;;) {
+        CubeOutcome cube;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&] { return !queue.empty() || walked || satisfied; });
+            if (satisfied || queue.empty()) break;
+            cube = std::move(queue.front());
+            queue.pop_front();
+        }
+        space.notify_one();
+        exchange(worker, exported, imported);
+
+        assumptions.clear();
+        for (size_t i = 0; i < cube.cube.size(); ++i) assumptions.push(mkLit(vars[i], cube.cube[i]));
+        uint64_t conflicts = solver.conflicts;
+        auto start = std::chrono::steady_clock::now();
+        cube.status = solver.solveLimited(assumptions);
+        cube.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        cube.conflicts = solver.conflicts - conflicts;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (satisfied) break;  // interrupted by the satisfiable cube of another worker
+        if (cube.status != l_Undef) solved++;
+        if (cube.status == l_True) {
+            satisfied = true;
+            solver.model.copyTo(model);
+            for (size_t w = 0; w < workers.size(); ++w) {
+                if ((int)w != worker) workers[w]->interrupt();
+            }
+            ready.notify_all();
+            space.notify_all();
+        } else if (cube.status == l_Undef) {
+            undecided = true;
+        }
+        if (report) report(cube);
+    }
+    solver.learnt_export = nullptr;
+}
+
+void Conquer::exchange(int worker, std::vector<std::vector<Lit>> &exported, size_t &imported) {
+    Solver &solver = *workers[worker];
+    std::vector<std::vector<Lit>> incoming;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &clause : exported) pool.emplace_back(worker, std::move(clause));
+        shared += exported.size();
+        for (; imported < pool.size(); ++imported) {
+            if (pool[imported].first != worker) incoming.push_back(pool[imported].second);
+        }
+    }
+    exported.clear();
+    vec<Lit> lits;
+    for (const auto &clause : incoming) {
+        lits.clear();
+        for (Lit p : clause) lits.push(p);
+        if (!solver.addClause(lits)) break;
+    }
+}
+
+}  // namespace Minisat
@@ -0,0 +1,69 @@
+#ifndef CONQUER_H
+#define CONQUER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+// A hard cube of a backdoor, solved by one of the workers
+struct CubeOutcome {
+    uint64_t index = 0;      // in the order of the cube tree walk
+    std::vector<int> cube;   // signs of the backdoor variables, 1 = negative
+    lbool status = l_Undef;  // l_Undef if the solve was stopped
+    double seconds = 0;
+    uint64_t conflicts = 0;
+};
+
+// Cube-and-conquer on a backdoor. The cube tree of the backdoor is walked on the calling thread
+// and its hard cubes are streamed through a bounded queue to 'numThreads' workers, each solving
+// them under assumptions on its own copy of the formula. Learnt clauses of at most 'shareSize'
+// literals are exchanged between the workers after every cube. The first satisfiable cube
+// interrupts the others; the formula is unsatisfiable if all cubes are.
+class Conquer {
+   public:
+    Conquer(const Solver &formula, int numThreads);
+
+    [[nodiscard]] int nThreads() const { return workers.size(); }
+
+    // l_True with 'model' set, l_False, or l_Undef if some cube could not be decided
+    lbool solve(const std::vector<int> &backdoor);
+
+    int shareSize = 8;        // 0 = no sharing
+    size_t queueSize = 1024;  // hard cubes waiting for a worker
+    // Called after every solved cube, one call at a time
+    std::function<void(const CubeOutcome &)> report;
+
+    vec<lbool> model;
+    uint64_t cubes = 0;   // hard cubes found by the walk
+    uint64_t solved = 0;  // of them solved by the workers
+    uint64_t shared = 0;  // clauses exported by the workers
+
+   private:
+    void work(int worker);
+    void exchange(int worker, std::vector<std::vector<Lit>> &exported, size_t &imported);
+
+    std::vector<std::unique_ptr<Solver>> workers;
+    Solver walker;
+    std::vector<int> vars;  // the backdoor being solved
+
+    std::mutex mutex;  // guards all the members below
+    std::condition_variable ready;  // cubes queued, or the walk is over
+    std::condition_variable space;  // a cube taken from a full queue, or a satisfiable one found
+    std::deque<CubeOutcome> queue;
+    bool walked = false;
+    bool satisfied = false;
+    bool undecided = false;
+    std::vector<std::pair<int, std::vector<Lit>>> pool;  // shared clauses with the worker exporting them
+};
+
+}  // namespace Minisat
+
+#endif
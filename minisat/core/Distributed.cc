@@ -0,0 +1,404 @@
+#include "minisat/core/Distributed.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "minisat/core/BackdoorKey.h"
+#include "minisat/core/EA.h"
+#include "minisat/core/FitnessCache.h"
+
+namespace Minisat {
+
+namespace {
+
+bool sendAll(int fd, const std::string &text) {
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+BackdoorRef refOf(const std::vector<int> &vars) {
+    uint64_t hash = 0;
+    for (int v : vars) hash ^= zobrist(v);
+    return BackdoorRef{vars.data(), vars.size(), (int)vars.size(), hash};
+}
+
+void writeVars(std::ostringstream &out, const std::vector<int> &vars) {
+    out << ' ' << vars.size();
+    for (int v : vars) out << ' ' << v;
+}
+
+bool readVars(std::istringstream &in, std::vector<int> &vars) {
+    size_t n;
+    if (!(in >> n)) return false;
+    vars.resize(n);
+    for (int &v : vars) {
+        if (!(in >> v) || v < 0) return false;
+    }
+    std::sort(vars.begin(), vars.end());
+    return true;
+}
+
+std::string entryLine(const RemoteBackdoor &entry) {
+    std::ostringstream out;
+    out.precision(17);
+    out << "CACHE " << entry.fitness.fitness << ' ' << entry.fitness.rho << ' ' << entry.fitness.hard;
+    writeVars(out, entry.vars);
+    out << '\n';
+    return out.str();
+}
+
+bool parseEntry(std::istringstream &in, RemoteBackdoor &entry) {
+    entry.run = 0;
+    entry.fitness = Fitness{};
+    return in >> entry.fitness.fitness >> entry.fitness.rho >> entry.fitness.hard && readVars(in, entry.vars);
+}
+
+}  // namespace
+
+std::vector<int> poolPartition(const std::vector<int> &pool, int partition, int partitions) {
+    size_t begin = pool.size() * partition / partitions;
+    size_t end = pool.size() * (partition + 1) / partitions;
+    return std::vector<int>(pool.begin() + begin, pool.begin() + end);
+}
+
+//=================================================================================================
+// Coordinator:
+
+struct Coordinator::Client {
+    int fd = -1;
+    int id = 0;
+    std::string buffer;
+    bool joined = false;
+    bool waiting = false;  // sent NEXT, not answered yet
+    bool closed = false;
+    int run = 0;            // assigned and not reported yet
+    size_t forwarded = 0;   // entries of 'shared' already sent
+};
+
+Coordinator::Coordinator(uint64_t job, int numRuns, int seed, int partitions, int topK)
+    : cache(std::make_shared<FitnessCache>()), job(job), num_runs(numRuns), seed(seed), partitions(partitions), top_k(topK),
+      done(numRuns, false) {
+    for (int run = 1; run <= numRuns; ++run) queue.push_back(run);
+}
+
+Coordinator::~Coordinator() {
+    for (auto &client : clients) {
+        if (!client->closed) close(client->fd);
+    }
+    if (listen_fd != -1) close(listen_fd);
+}
+
+bool Coordinator::listen(int port, std::string &error) {
+    listen_fd = socket(AF_INET6, SOCK_STREAM, 0);
+    bool v6 = listen_fd != -1;
+    if (!v6) listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd == -1) {
+        error = std::string("socket: ") + strerror(errno);
+        return false;
+    }
+    int on = 1, off = 0;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    int bound;
+    if (v6) {
+        setsockopt(listen_fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));  // also accept IPv4
+        sockaddr_in6 address{};
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons(port);
+        bound = bind(listen_fd, (sockaddr *)&address, sizeof(address));
+    } else {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        bound = bind(listen_fd, (sockaddr *)&address, sizeof(address));
+    }
+    if (bound != 0 || ::listen(listen_fd, 64) != 0) {
+        error = "port " + std::to_string(port) + ": " + strerror(errno);
+        return false;
+    }
+    sockaddr_storage address{};
+    socklen_t length = sizeof(address);
+    getsockname(listen_fd, (sockaddr *)&address, &length);
+    bound_port = ntohs(v6 ? ((sockaddr_in6 *)&address)->sin6_port : ((sockaddr_in *)&address)->sin_port);
+    return true;
+}
+
+void Coordinator::serve() {
+    int next_id = 1;
+    while (completed < num_runs) {
+        std::vector<pollfd> fds{{listen_fd, POLLIN, 0}};
+        for (auto &client : clients) fds.push_back({client->fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd != -1) {
+                clients.emplace_back(new Client);
+                clients.back()->fd = fd;
+                clients.back()->id = next_id++;
+            }
+        }
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) continue;
+            Client &client = *clients[i - 1];
+            char data[65536];
+            ssize_t n = recv(client.fd, data, sizeof(data), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                drop(client);
+                continue;
+            }
+            client.buffer.append(data, n);
+            size_t start = 0, end;
+            while (!client.closed && (end = client.buffer.find('\n', start)) != std::string::npos) {
+                if (!handle(client, client.buffer.substr(start, end - start))) drop(client);
+                start = end + 1;
+            }
+            client.buffer.erase(0, start);
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(), [](const std::unique_ptr<Client> &c) { return c->closed; }),
+                      clients.end());
+        for (auto &client : clients) {
+            if (client->waiting) dispatch(*client);
+        }
+    }
+
+    // Every run is done: release the waiting workers, and the others when they ask
+    for (auto &client : clients) {
+        if (!client->closed) {
+            sendAll(client->fd, "DONE\n");
+            close(client->fd);
+            client->closed = true;
+        }
+    }
+    clients.clear();
+}
+
+bool Coordinator::handle(Client &client, const std::string &line) {
+    std::istringstream in(line);
+    std::string command;
+    in >> command;
+    if (command == "HELLO") {
+        uint64_t theirs = 0;
+        in >> theirs;
+        if (theirs != job) {
+            sendAll(client.fd, "ERROR the job differs (formula, pool or EA options)\n");
+            if (log) *log << "Worker " << client.id << " refused: the job differs" << std::endl;
+            return false;
+        }
+        client.joined = true;
+        workers++;
+        if (log) *log << "Worker " << client.id << " joined" << std::endl;
+        return sendAll(client.fd, "OK\n");
+    }
+    if (!client.joined) return false;
+
+    if (command == "NEXT") {
+        client.waiting = true;
+    } else if (command == "CACHE") {
+        RemoteBackdoor entry;
+        if (!parseEntry(in, entry)) return false;
+        entries++;
+        BackdoorRef key = refOf(entry.vars);
+        Fitness known;
+        if (!cache->find(key, known) || !known.exact()) {
+            cache->insert(key, entry.fitness);
+            newEntries++;
+            shared.emplace_back(client.id, std::move(entry));
+        }
+    } else if (command == "RESULT") {
+        RemoteBackdoor result;
+        int lowerBound = 0;
+        if (!(in >> result.run >> result.fitness.fitness >> result.fitness.rho >> result.fitness.hard >> lowerBound >> result.fitness.error) ||
+            !readVars(in, result.vars) || result.run < 1 || result.run > num_runs) {
+            return false;
+        }
+        result.fitness.lowerBound = lowerBound != 0;
+        if (client.run == result.run) client.run = 0;
+        if (done[result.run - 1]) return true;  // also reported by the worker it was handed out to again
+        done[result.run - 1] = true;
+        completed++;
+        addResult(result);
+        if (log) *log << "Run " << result.run << " done by worker " << client.id << ", fitness " << result.fitness.fitness
+                      << " (" << completed << "/" << num_runs << ")" << std::endl;
+        if (onResult) onResult(result);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Coordinator::dispatch(Client &client) {
+    std::string text;
+    if (!queue.empty()) {
+        int run = queue.front();
+        queue.pop_front();
+        for (; client.forwarded < shared.size(); ++client.forwarded) {
+            if (shared[client.forwarded].first != client.id) text += entryLine(shared[client.forwarded].second);
+        }
+        text += "RUN " + std::to_string(run) + ' ' + std::to_string(EvolutionaryAlgorithm::runSeed(seed, run)) + ' ' +
+                std::to_string((run - 1) % partitions) + ' ' + std::to_string(partitions) + '\n';
+        client.run = run;
+        if (log) *log << "Run " << run << " to worker " << client.id << std::endl;
+    } else if (completed == num_runs) {
+        text = "DONE\n";
+    } else {
+        return;  // wait for the runs in progress, one of them may be handed out again
+    }
+    client.waiting = false;
+    if (!sendAll(client.fd, text)) drop(client);
+}
+
+void Coordinator::drop(Client &client) {
+    if (client.closed) return;
+    close(client.fd);
+    client.closed = true;
+    client.waiting = false;
+    if (client.run != 0 && !done[client.run - 1]) {
+        queue.push_front(client.run);
+        reassigned++;
+        if (log) *log << "Worker " << client.id << " left, run " << client.run << " is handed out again" << std::endl;
+    } else if (client.joined && log) {
+        *log << "Worker " << client.id << " left" << std::endl;
+    }
+    client.run = 0;
+}
+
+void Coordinator::addResult(const RemoteBackdoor &result) {
+    auto same = std::find_if(best.begin(), best.end(), [&](const RemoteBackdoor &b) { return b.vars == result.vars; });
+    if (same != best.end()) {
+        duplicates++;
+        if (result.fitness < same->fitness) same->fitness = result.fitness;
+    } else {
+        best.push_back(result);
+    }
+    std::stable_sort(best.begin(), best.end(), [](const RemoteBackdoor &a, const RemoteBackdoor &b) { return a.fitness < b.fitness; });
+    if ((int)best.size() > top_k) best.resize(top_k);
+}
+
+//=================================================================================================
+// Worker:
+
+Worker::~Worker() {
+    if (fd != -1) close(fd);
+}
+
+bool Worker::connect(const std::string &address, uint64_t job, double retrySeconds, std::string &error) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        error = "expected host:port, got " + address;
+        return false;
+    }
+    std::string host = address.substr(0, colon), port = address.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *found = nullptr;
+    int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &found);
+    if (status != 0) {
+        error = host + ": " + gai_strerror(status);
+        return false;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(retrySeconds);
+    for (;;) {
+        for (addrinfo *a = found; a != nullptr && fd == -1; a = a->ai_next) {
+            fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd != -1 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+                error = address + ": " + strerror(errno);
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (fd != -1 || std::chrono::steady_clock::now() >= deadline) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    freeaddrinfo(found);
+    if (fd == -1) return false;
+
+    std::string reply;
+    if (!send("HELLO " + std::to_string(job) + '\n') || !readLine(reply)) {
+        error = address + ": connection closed";
+        return false;
+    }
+    if (reply != "OK") {
+        error = address + ": " + (reply.compare(0, 6, "ERROR ") == 0 ? reply.substr(6) : reply);
+        return false;
+    }
+    return true;
+}
+
+bool Worker::next(RunAssignment &run, FitnessCache *cache) {
+    if (!send("NEXT\n")) return false;
+    std::string line;
+    while (readLine(line)) {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+        if (command == "CACHE") {
+            RemoteBackdoor entry;
+            if (parseEntry(in, entry) && cache) cache->insert(refOf(entry.vars), entry.fitness, false);
+        } else if (command == "RUN") {
+            return (bool)(in >> run.run >> run.seed >> run.partition >> run.partitions);
+        } else {
+            return false;  // DONE
+        }
+    }
+    return false;
+}
+
+bool Worker::report(const RemoteBackdoor &result, const std::vector<RemoteBackdoor> &entries) {
+    std::string text;
+    for (const auto &entry : entries) text += entryLine(entry);
+    std::ostringstream out;
+    out.precision(17);
+    out << "RESULT " << result.run << ' ' << result.fitness.fitness << ' ' << result.fitness.rho << ' ' << result.fitness.hard << ' '
+        << (int)result.fitness.lowerBound << ' ' << result.fitness.error;
+    writeVars(out, result.vars);
+    out << '\n';
+    return send(text + out.str());
+}
+
+bool Worker::readLine(std::string &line) {
+    for (;;) {
+        size_t end = buffer.find('\n');
+        if (end != std::string::npos) {
+            line = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            return true;
+        }
+        char data[65536];
+        ssize_t n = recv(fd, data, sizeof(data), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer.append(data, n);
+    }
+}
+
+bool Worker::send(const std::string &text) {
+    return sendAll(fd, text);
+}
+
+}  // namespace Minisat
@@ -0,0 +1,126 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "minisat/core/Fitness.h"
+
+namespace Minisat {
+
+class FitnessCache;
+
+// A run result or a fitness cache entry, as exchanged between the coordinator and its workers
+struct RemoteBackdoor {
+    int run = 0;            // 1-based; 0 for cache entries
+    Fitness fitness{};
+    std::vector<int> vars;  // sorted, 0-based
+};
+
+// A run handed out to a worker: its seed and the slice of the pool it draws from
+struct RunAssignment {
+    int run = 0;
+    int seed = 0;
+    int partition = 0;
+    int partitions = 1;
+};
+
+// Slice 'partition' of 'pool' cut into 'partitions' contiguous slices of nearly equal size
+std::vector<int> poolPartition(const std::vector<int> &pool, int partition, int partitions);
+
+// Coordinator of EA runs spread over processes. Workers connect over TCP and ask for one run at
+// a time, so faster workers take more of them; the run of a worker that disconnects before
+// reporting it is handed out again. Results are deduplicated by their variables into a global
+// top-K. The exact cache entries reported by workers are deduplicated in 'cache' and forwarded
+// to the other workers along with their next run.
+//
+// The protocol is line-based text; a worker sends
+//   HELLO <job>     answered by OK, or ERROR <message> if its job fingerprint differs
+//   NEXT            answered by the new CACHE lines, then RUN <run> <seed> <partition> <partitions> or DONE
+//   CACHE <fitness> <rho> <hard> <n> <vars>
+//   RESULT <run> <fitness> <rho> <hard> <lower bound> <error> <n> <vars>
+class Coordinator {
+   public:
+    // Runs 1..'numRuns' with seeds 'EvolutionaryAlgorithm::runSeed(seed, run)'; run r draws from
+    // pool partition (r - 1) % 'partitions'
+    Coordinator(uint64_t job, int numRuns, int seed, int partitions, int topK);
+    ~Coordinator();
+
+    Coordinator(const Coordinator &) = delete;
+    Coordinator &operator=(const Coordinator &) = delete;
+
+    // Listens on all interfaces; port 0 picks a free one (see 'port')
+    bool listen(int port, std::string &error);
+    [[nodiscard]] int port() const { return bound_port; }
+
+    // Serves workers until every run has a result, then tells them all to stop
+    void serve();
+
+    std::shared_ptr<FitnessCache> cache;                   // optional, collects the reported entries
+    std::function<void(const RemoteBackdoor &)> onResult;  // called for every run result
+    std::ostream *log = nullptr;                           // connections and assignments
+
+    // The best distinct results, best first
+    [[nodiscard]] const std::vector<RemoteBackdoor> &top() const { return best; }
+
+    int workers = 0;           // workers that joined
+    int reassigned = 0;        // runs handed out again
+    uint64_t entries = 0;      // cache entries received
+    uint64_t newEntries = 0;   // of them not already known
+    int duplicates = 0;        // results with the variables of an earlier one
+
+   private:
+    struct Client;
+
+    bool handle(Client &client, const std::string &line);
+    void dispatch(Client &client);
+    void drop(Client &client);
+    void addResult(const RemoteBackdoor &result);
+
+    uint64_t job;
+    int num_runs, seed, partitions, top_k;
+    int listen_fd = -1;
+    int bound_port = 0;
+    std::vector<std::unique_ptr<Client>> clients;
+    std::deque<int> queue;  // runs to hand out
+    std::vector<char> done;
+    int completed = 0;
+    std::vector<std::pair<int, RemoteBackdoor>> shared;  // new cache entries with the worker reporting them
+    std::vector<RemoteBackdoor> best;
+};
+
+// Worker side of a 'Coordinator'
+class Worker {
+   public:
+    Worker() = default;
+    ~Worker();
+
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    // Connects to "host:port", retrying for up to 'retrySeconds' while the coordinator is not up
+    bool connect(const std::string &address, uint64_t job, double retrySeconds, std::string &error);
+
+    // The next run; false once all runs are done or the coordinator is gone. The forwarded cache
+    // entries are inserted into 'cache' (if any) without persisting them.
+    bool next(RunAssignment &run, FitnessCache *cache);
+
+    // Reports the result of a run together with the cache entries found by it
+    bool report(const RemoteBackdoor &result, const std::vector<RemoteBackdoor> &entries);
+
+   private:
+    bool readLine(std::string &line);
+    bool send(const std::string &text);
+
+    int fd = -1;
+    std::string buffer;
+};
+
+}  // namespace Minisat
+
+#endif
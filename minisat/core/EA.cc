@@ -2,12 +2,19 @@
 
 #include <algorithm>
 #include <chrono>
-#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <random>
+#include <sstream>
 #include <utility>
 #include <vector>
 
+#include "minisat/core/Checkpoint.h"
+#include "minisat/core/ParallelTree.h"
+#include "minisat/core/PropEngine.h"
+#include "minisat/core/Strategy.h"
+
 namespace Minisat {
 
 template <typename T>
@@ -28,104 +35,318 @@ void printVector(const std::vector<T> &myVector, std::ostream &os = std::cout) {
     os << myVector << std::endl;
 }
 
-EvolutionaryAlgorithm::EvolutionaryAlgorithm(Solver &solver, int seed) : solver(solver) {
+EvolutionaryAlgorithm::EvolutionaryAlgorithm(Solver &solver, int seed, std::shared_ptr<FitnessCache> cache)
+    : solver(solver), cache(cache ? std::move(cache) : std::make_shared<FitnessCache>()) {
     if (seed != -1) {
         gen.seed(seed);
     }
 }
 
+EvolutionaryAlgorithm::~EvolutionaryAlgorithm() = default;
+
+int EvolutionaryAlgorithm::runSeed(int seed, int run) {
+    std::seed_seq seq{seed, run};
+    uint32_t value;
+    seq.generate(&value, &value + 1);
+    return static_cast<int>(value & INT32_MAX);
+}
+
+// Run the evolutionary algorithm, appending the best backdoor to the job's output
+Instance EvolutionaryAlgorithm::run(
+    int numIterations,
+    int instanceSize,
+    std::vector<int> pool,
+    ResultWriter &results,
+    int seed) {
+    std::ostringstream record;
+    Instance best = run(numIterations, instanceSize, std::move(pool), record, seed);
+    if (interrupted) return best;
+
+    if (results.isOpen()) {
+        results.write(record.str());
+    } else {
+        *out << "Error opening the file." << std::endl;
+    }
+
+    return best;
+}
+
 // Run the evolutionary algorithm
 Instance EvolutionaryAlgorithm::run(
     int numIterations,
     int instanceSize,
     std::vector<int> pool,
-    const char* backdoor_path,
+    std::ostream &backdoorOut,
     int seed) {
     if (seed != -1) {
         gen.seed(seed);
     }
+    interrupted = false;
+    RunState resume;
+    bool resumed = false;
+    if (checkpoint && checkpoint->get(runNumber, resume)) {
+        gen = resume.gen;
+        int *counters[] = {&cache_hits, &cache_misses, &cached_hits, &cached_misses,
+                           &early_aborts, &estimates, &exact_rechecks, &batch_duplicates, &cross_checks};
+        for (size_t k = 0; k < resume.counters.size() && k < std::size(counters); ++k) {
+            *counters[k] = resume.counters[k];
+        }
+        resumed = resume.started;
+    }
+    acceptance.clear();
+    if (scoreBias > 0 && !varScores.empty()) {
+        double maxScore = 0;
+        for (int v : pool) maxScore = std::max(maxScore, varScores[v]);
+        if (maxScore > 0) {
+            acceptance.assign(varScores.size(), 1);
+            double sum = 0;
+            for (int v : pool) {
+                acceptance[v] = (1 - scoreBias) + scoreBias * varScores[v] / maxScore;
+                sum += acceptance[v];
+            }
+            holeAcceptance = sum / pool.size();
+        }
+    }
 
-    std::cout << "Running EA for " << numIterations << " iterations..." << std::endl;
-    std::cout << "instance size: " << instanceSize << std::endl;
-    std::cout << "solver variables: " << solver.nVars() << std::endl;
-    std::cout << "pool size: " << pool.size() << std::endl;
-    std::cout << '\n';
+    engine.reset();
+    batchEngines.clear();
+    if (usePropEngine) {
+        engine.reset(new PropEngine(solver));
+        engine->bitLevels = bitLevels;
+        engine->dynamicOrder = dynamicOrder;
+        engine->components = components > 0;
+        engine->componentMinVars = components;
+        for (size_t i = 0; i < batchSolvers.size(); ++i) {
+            batchEngines.emplace_back(new PropEngine(*engine));
+        }
+    }
+    // Evaluation scratch for the largest backdoor of the run:
+    const size_t maxVars = numSlots(instanceSize, pool.size());
+    context.reserve(maxVars);
+    for (EvalContext &c : batchContexts) c.reserve(maxVars);
+
+    stopReason = StopReason::None;
+    run_start = std::chrono::steady_clock::now();
+    run_evaluations = checked_evaluations = cache_misses;
+    run_propagations = checked_propagations = workCounters().propagations;
+    if (telemetry) {
+        WorkCounters work = workCounters();
+        run_summary = RunSummary();
+        run_summary.propagations = work.propagations;
+        run_summary.nodes = work.nodes;
+        run_summary.conflicts = work.conflicts;
+        run_summary.cacheHits = cache_hits;
+        run_summary.cacheMisses = cache_misses;
+        run_summary.cachedHits = cached_hits;
+        run_summary.cachedMisses = cached_misses;
+        run_summary.earlyAborts = early_aborts;
+    }
 
-    // Initial instance:
-    Instance instance = initialize(instanceSize, std::move(pool));
+    *out << "Running EA for " << numIterations << " iterations..." << std::endl;
+    *out << "instance size: " << instanceSize << std::endl;
+    if (omega > 0) *out << "variable size up to " << numSlots(instanceSize, pool.size()) << ", omega: " << omega << std::endl;
+    *out << "solver variables: " << solver.nVars() << std::endl;
+    *out << "pool size: " << pool.size() << std::endl;
+    if (strategy && !isGenerational()) *out << "strategy: " << strategy->name() << std::endl;
+    *out << '\n';
+
+    // Initial instance (the rest of the population is drawn from the same pool):
+    std::vector<int> initialPool;
+    if (isGenerational()) initialPool = pool;
+    Instance instance = resumed ? resume.population.front() : initialize(instanceSize, std::move(pool));
+    instance.omega = omega;
+    if (resumed) front.assign(std::move(resume.front));
+    else front.clear();
     if (instance.pool.empty()) {
-        std::cout << "Pool of variables is empty, cannot run!" << std::endl;
+        *out << "Pool of variables is empty, cannot run!" << std::endl;
         return instance;
     }
-    Fitness fit = calculateFitness(instance);
-    std::cout << "Initial fitness " << fit.fitness
-              << " (rho=" << fit.rho << ", hard=" << fit.hard << ")"
-              << " for " << instance.numVariables() << " vars: "
-              << instance
-              << std::endl;
-
-    int bestIteration = 0;
-    Instance best = instance;
-    Fitness bestFitness = fit;
+    Fitness fit{};
+    if (resumed) {
+        fit = resume.fits.front();
+        *out << "Resumed after iteration " << resume.iteration
+             << " with best fitness " << resume.bestFitness.fitness << std::endl;
+    } else {
+        fit = calculateFitness(instance);
+        *out << "Initial fitness " << fit.fitness
+                  << " (rho=" << fit.rho << ", hard=" << fit.hard << ")"
+                  << " for " << instance.numVariables() << " vars: "
+                  << instance
+                  << std::endl;
+    }
 
-    for (int i = 1; i <= numIterations; ++i) {
-        // if (i <= 10 || i % 100 == 0) {
-        //     std::cout << "\n=== Iteration #" << i << std::endl;
-        // }
+    int firstIteration = resumed ? resume.iteration + 1 : 1;
+    int lastIteration = firstIteration - 1;
+    int bestIteration = resumed ? resume.bestIteration : 0;
+    Instance best = resumed ? *resume.best : instance;
+    best.omega = omega;
+    Fitness bestFitness = resumed ? resume.bestFitness : fit;
+    if (strategy && !isGenerational()) {
+        if (resumed) strategy->restore(resume.strategy);
+        else strategy->reset(instance, fit);
+    }
 
-        auto startTime = std::chrono::high_resolution_clock::now();
+    if (isGenerational()) {
+        std::vector<Instance> population{instance};
+        std::vector<Fitness> fits{fit};
+        if (resumed) {
+            population = std::move(resume.population);
+            fits = std::move(resume.fits);
+            for (Instance &member : population) member.omega = omega;
+        }
+        lastIteration = evolveGenerations(numIterations, instanceSize, initialPool, population, fits, best, bestFitness, bestIteration, firstIteration);
+    } else {
+        std::vector<int> bestSlots = best.data;  // 'best' is built from them for checkpoints and at the end
+        for (int i = firstIteration; i <= numIterations; ++i) {
+            lastIteration = i;
+            // if (i <= 10 || i % 100 == 0) {
+            //     std::cout << "\n=== Iteration #" << i << std::endl;
+            // }
+
+            auto startTime = std::chrono::high_resolution_clock::now();
+            WorkCounters before;
+            bool sampled = telemetry && telemetry->sampled(i);
+            if (sampled) before = workCounters();
+            int hitsBefore = cache_hits, missesBefore = cache_misses;
+
+            // The mutant takes the place of 'instance' until it is undone:
+            parent = instance.data;
+            moves.clear();
+            Fitness mutatedFitness{};
+            bool accepted;
+            if (strategy) {
+                accepted = strategy->step(*this, i, numIterations, instance, fit, mutatedFitness);
+            } else {
+                mutate(instance);
+                mutatedFitness = calculateFitness(instance, &parent, earlyAbort ? &fit : nullptr);
+                accepted = mutatedFitness <= fit;
+            }
 
-        Instance mutatedInstance = instance;  // copy
-        mutate(mutatedInstance);
+            auto endTime = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+            if (i <= 10 || (i < 1000 && i % 100 == 0) || (i < 10000 && i % 1000 == 0) || (i % 10000 == 0)) {
+                bool bound = mutatedFitness.lowerBound;
+                *out << "[" << i << "/" << numIterations << "] "
+                          << "Fitness " << (bound ? ">= " : "") << mutatedFitness.fitness;
+                if (mutatedFitness.error != 0) {
+                    *out << " +- " << mutatedFitness.error;
+                }
+                *out << " (rho" << (bound ? "<=" : "=") << mutatedFitness.rho
+                          << ", hard" << (bound ? ">=" : "=") << mutatedFitness.hard
+                          << ") for " << instance.numVariables() << " vars "
+                          << instance << " in " << duration.count() << " ms"
+                          << std::endl;
+            }
 
-        Fitness mutatedFitness = calculateFitness(mutatedInstance);
+            if (telemetry) {
+                IterationSample sample;
+                sample.iteration = i;
+                sample.seconds = std::chrono::duration<double>(endTime - startTime).count();
+                sample.accepted = accepted;
+                sample.improved = mutatedFitness < bestFitness;
+                sample.fitness = mutatedFitness;
+                sample.numVars = instance.numVariables();
+                run_summary.hard.add(mutatedFitness.hard);
+                recordIteration(sample, sampled ? &before : nullptr, hitsBefore, missesBefore);
+            }
 
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        if (i <= 10 || (i < 1000 && i % 100 == 0) || (i < 10000 && i % 1000 == 0) || (i % 10000 == 0)) {
-            std::cout << "[" << i << "/" << numIterations << "] "
-                      << "Fitness " << mutatedFitness.fitness
-                      << " (rho=" << mutatedFitness.rho
-                      << ", hard=" << mutatedFitness.hard
-                      << ") for " << mutatedInstance.numVariables() << " vars "
-                      << mutatedInstance << " in " << duration.count() << " ms"
-                      << std::endl;
-        }
+            // Update the best
+            if (mutatedFitness < bestFitness) {
+                bestIteration = i;
+                bestSlots = instance.data;
+                bestFitness = mutatedFitness;
+            }
 
-        // Update the best
-        if (mutatedFitness < bestFitness) {
-            bestIteration = i;
-            best = mutatedInstance;
-            bestFitness = mutatedFitness;
-        }
+            // (1+1) strategy: keep the mutant if it is not worse than the current instance
+            if (accepted) {
+                fit = mutatedFitness;
+            } else {
+                undoMoves(instance, fit);
+            }
 
-        // (1+1) strategy: replace 'current' instance if mutated is not worse
-        if (mutatedFitness <= fit) {
-            instance = mutatedInstance;
-            fit = mutatedFitness;
+            if (checkpoint && checkpoint->due() &&
+                checkpointIteration(i, {instance}, {fit}, withSlots(instance, bestSlots), bestFitness, bestIteration)) {
+                break;
+            }
+            if ((stopReason = checkBudget(i, bestIteration)) != StopReason::None) {
+                break;
+            }
         }
+        best = withSlots(instance, bestSlots);
+    }
+    if (interrupted) {
+        stopReason = StopReason::Interrupted;
+        return best;
+    }
+    if (stopReason == StopReason::None) {
+        stopReason = StopReason::Iterations;
+    }
+    *out << "Stopped after iteration " << lastIteration << ": " << toString(stopReason) << std::endl;
+
+    if (telemetry) {
+        WorkCounters work = workCounters();
+        RunSummary &r = run_summary;
+        r.run = runNumber;
+        r.iterations = lastIteration;
+        r.reason = stopReason;
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+        r.best = bestFitness;
+        r.bestIteration = bestIteration;
+        r.propagations = work.propagations - r.propagations;
+        r.nodes = work.nodes - r.nodes;
+        r.conflicts = work.conflicts - r.conflicts;
+        r.cacheHits = cache_hits - r.cacheHits;
+        r.cacheMisses = cache_misses - r.cacheMisses;
+        r.cachedHits = cached_hits - r.cachedHits;
+        r.cachedMisses = cached_misses - r.cachedMisses;
+        r.earlyAborts = early_aborts - r.earlyAborts;
+        telemetry->run(r);
     }
 
+    lastFitness = bestFitness;
     std::vector<int> bestVars = best.getVariables();
-    std::cout << "Best fitness " << bestFitness.fitness
+    *out << "Best fitness " << bestFitness.fitness
               << " (rho=" << bestFitness.rho
               << ", hard=" << bestFitness.hard
               << ") on iteration " << bestIteration
               << " with " << bestVars.size() << " variables: " << bestVars
               << std::endl;
 
-    // Dump best to file
-    std::ofstream outFile(backdoor_path, std::ios::app);
-    if (outFile.is_open()) {
-        outFile << "Best fitness " << bestFitness.fitness
-                << " (rho=" << bestFitness.rho
-                << ", hard=" << bestFitness.hard
-                << ") on iteration " << bestIteration
-                << " with " << bestVars.size() << " variables: " << bestVars
-                << std::endl;
-        outFile.close();
-    } else {
-        std::cout << "Error opening the file." << std::endl;
+    // Dump best to output
+    RunResult result;
+    result.run = runNumber;
+    result.iteration = bestIteration;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+    result.reason = stopReason;
+    result.fitness = bestFitness;
+    result.vars = bestVars;
+    if (exportCubes > 0 && bestFitness.exact() && bestFitness.hard <= exportCubes) {
+        uint64_t total = 0;
+        solver.gen_all_valid_assumptions_tree(bestVars, total, [&](const std::vector<int> &cube) {
+            result.cubes.insert(result.cubes.end(), cube.begin(), cube.end());
+        });
+    }
+    formatResult(backdoorOut, resultFormat, result);
+
+    if (omega > 0) {
+        *out << "Size/hardness front of " << front.get().size() << " backdoors:" << std::endl;
+        RunResult point;
+        point.kind = RunResult::Kind::Front;
+        point.run = runNumber;
+        for (const ParetoFront::Point &p : front.get()) {
+            *out << "  " << p.size << " variables, rho=" << p.fitness.rho << ", hard=" << p.fitness.hard << ", fitness " << p.fitness.fitness
+                 << ": " << p.vars << std::endl;
+            point.fitness = p.fitness;
+            point.vars = p.vars;
+            formatResult(backdoorOut, resultFormat, point);
+        }
+    }
+
+    if (printTreeShape && engine && bestFitness.exact()) {
+        std::vector<uint64_t> shape = engine->tree_shape(bestVars);
+        *out << "Tree shape (nodes per level):";
+        for (uint64_t nodes : shape) *out << ' ' << nodes;
+        *out << std::endl;
     }
 
     // if (bestFitness.hard <= 16) {
@@ -149,14 +370,369 @@ Instance EvolutionaryAlgorithm::run(
     //     std::cout << "Too many hard tasks (" << bestFitness.hard << ")" << std::endl;
     // }
 
-    std::cout << "Cache hits: " << cache_hits << std::endl;
-    std::cout << "Cache misses: " << cache_misses << std::endl;
-    // std::cout << "Cached hits: " << cached_hits << std::endl;
-    // std::cout << "Cached misses: " << cached_misses << std::endl;
+    *out << "Cache hits: " << cache_hits << std::endl;
+    *out << "Cache misses: " << cache_misses << std::endl;
+    if (earlyAbort) {
+        *out << "Early aborts: " << early_aborts << std::endl;
+    }
+    if (isGenerational()) {
+        *out << "Duplicate offspring: " << batch_duplicates << std::endl;
+    }
+    if (samples > 0) {
+        *out << "Sampled estimates: " << estimates << ", exact rechecks: " << exact_rechecks << std::endl;
+    }
+    if (crossCheck > 0) {
+        *out << "Cross-checked backdoors: " << cross_checks << std::endl;
+    }
+    if (engine && components > 0) {
+        uint64_t splits = engine->splits;
+        for (const auto &e : batchEngines) splits += e->splits;
+        *out << "Component splits: " << splits << std::endl;
+    }
+    if (incremental) {
+        *out << "Incremental prefix hits: " << incremental->hits
+             << ", misses: " << incremental->misses << std::endl;
+    }
+    *out << "Cached hits: " << cached_hits << std::endl;
+    *out << "Cached misses: " << cached_misses << std::endl;
 
     return best;
 }
 
+RunState EvolutionaryAlgorithm::pendingState(int run) const {
+    RunState state;
+    state.run = run;
+    state.gen = gen;
+    state.counters = {cache_hits, cache_misses, cached_hits, cached_misses,
+                      early_aborts, estimates, exact_rechecks, batch_duplicates, cross_checks};
+    return state;
+}
+
+bool EvolutionaryAlgorithm::checkpointIteration(
+    int iteration,
+    const std::vector<Instance> &population,
+    const std::vector<Fitness> &fits,
+    const Instance &best,
+    const Fitness &bestFitness,
+    int bestIteration) {
+    RunState state = pendingState(runNumber);
+    state.started = true;
+    state.iteration = iteration;
+    state.bestIteration = bestIteration;
+    state.population = population;
+    state.fits = fits;
+    state.best = best;
+    state.bestFitness = bestFitness;
+    state.front = front.get();
+    if (strategy && !isGenerational()) state.strategy = strategy->save();
+    checkpoint->update(state);
+    if (checkpoint->interrupted()) {
+        *out << "Interrupted after iteration " << iteration << ", state saved" << std::endl;
+        interrupted = true;
+    }
+    return interrupted;
+}
+
+StopReason EvolutionaryAlgorithm::checkBudget(int iteration, int bestIteration) {
+    uint64_t evaluations = cache_misses;
+    uint64_t propagations = workCounters().propagations;
+    if (jobUsage) {
+        jobUsage->evaluations += evaluations - checked_evaluations;
+        jobUsage->propagations += propagations - checked_propagations;
+    }
+    checked_evaluations = evaluations;
+    checked_propagations = propagations;
+
+    if (cancel && *cancel) return StopReason::Interrupted;
+    const Budget &b = runBudget;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+    if (b.stagnation > 0 && iteration - bestIteration >= b.stagnation) return StopReason::Stagnation;
+    if (b.seconds > 0 && seconds >= b.seconds) return StopReason::Time;
+    if (b.evaluations > 0 && evaluations - run_evaluations >= b.evaluations) return StopReason::Evaluations;
+    if (b.propagations > 0 && propagations - run_propagations >= b.propagations) return StopReason::Propagations;
+    return jobUsage ? jobUsage->check(jobBudget) : StopReason::None;
+}
+
+EvolutionaryAlgorithm::WorkCounters EvolutionaryAlgorithm::workCounters() const {
+    WorkCounters work;
+    work.propagations = solver.propagations;
+    for (const auto &s : batchSolvers) work.propagations += s->propagations;
+    if (parallel) work.propagations += parallel->propagations();
+    auto addEngine = [&](const PropEngine &e) {
+        work.propagations += e.propagations;
+        work.nodes += e.nodes;
+        work.conflicts += e.conflicts;
+    };
+    if (engine) addEngine(*engine);
+    for (const auto &e : batchEngines) addEngine(*e);
+    return work;
+}
+
+void EvolutionaryAlgorithm::recordIteration(IterationSample &sample, const WorkCounters *before, int hitsBefore, int missesBefore) {
+    run_summary.evalMicros.add(static_cast<uint64_t>(sample.seconds * 1e6));
+    if (!before) return;
+    WorkCounters work = workCounters();
+    sample.run = runNumber;
+    sample.propagations = work.propagations - before->propagations;
+    sample.nodes = work.nodes - before->nodes;
+    sample.conflicts = work.conflicts - before->conflicts;
+    sample.cacheHits = cache_hits - hitsBefore;
+    sample.cacheMisses = cache_misses - missesBefore;
+    telemetry->iteration(sample);
+}
+
+void EvolutionaryAlgorithm::setBatchThreads(int numThreads) {
+    batchSolvers.clear();
+    batchContexts.clear();
+    batchPool.reset();
+    if (numThreads <= 1) return;
+    for (int i = 0; i < numThreads; ++i) {
+        batchSolvers.emplace_back(new Solver);
+        solver.copyTo(*batchSolvers.back());
+    }
+    batchContexts.resize(numThreads);
+    batchPool.reset(new ThreadPool(numThreads));
+}
+
+// Generational loop: each iteration makes 'lambda' offspring of uniformly chosen members,
+// evaluates them as one batch and keeps the 'mu' best (offspring first on ties).
+int EvolutionaryAlgorithm::evolveGenerations(
+    int numIterations,
+    int instanceSize,
+    const std::vector<int> &pool,
+    std::vector<Instance> &population,
+    std::vector<Fitness> &fits,
+    Instance &best,
+    Fitness &bestFitness,
+    int &bestIteration,
+    int firstIteration) {
+    const int size = comma ? std::min(mu, lambda) : mu;
+
+    while (static_cast<int>(population.size()) < mu) {
+        Instance member = initialize(instanceSize, pool);
+        Fitness fitness = calculateFitness(member);
+        if (fitness < bestFitness) {
+            best = member;
+            bestFitness = fitness;
+        }
+        population.push_back(std::move(member));
+        fits.push_back(fitness);
+    }
+
+    // Kept between generations: copies are assigned into the existing instances, reusing their buffers
+    std::vector<Instance> offspring;
+    std::vector<Fitness> offspringFits;
+    std::vector<Instance> nextPopulation;
+    std::vector<Fitness> nextFits;
+    std::vector<int> order;
+    std::vector<BackdoorKey> selected;
+    int lastIteration = firstIteration - 1;
+    for (int i = firstIteration; i <= numIterations; ++i) {
+        lastIteration = i;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        WorkCounters before;
+        bool sampled = telemetry && telemetry->sampled(i);
+        if (sampled) before = workCounters();
+        int hitsBefore = cache_hits, missesBefore = cache_misses;
+        bool improved = false;
+
+        std::uniform_int_distribution<size_t> dis_parent(0, population.size() - 1);
+        for (int k = 0; k < lambda; ++k) {
+            const Instance &parent = population[dis_parent(gen)];
+            if (k < static_cast<int>(offspring.size())) {
+                offspring[k] = parent;  // copy
+            } else {
+                offspring.push_back(parent);
+            }
+            mutate(offspring[k]);
+        }
+
+        // With (mu+lambda), offspring worse than the worst member can not be selected:
+        const Fitness *threshold = nullptr;
+        if (!comma && earlyAbort) {
+            threshold = &*std::max_element(fits.begin(), fits.end());
+        }
+        evaluateBatch(offspring, offspringFits, threshold);
+
+        for (int k = 0; k < lambda; ++k) {
+            if (telemetry) run_summary.hard.add(offspringFits[k].hard);
+            if (offspringFits[k] < bestFitness) {
+                improved = true;
+                bestIteration = i;
+                best = offspring[k];
+                bestFitness = offspringFits[k];
+            }
+        }
+
+        // Candidates in order of fitness: offspring first, then (unless 'comma') the population:
+        int numCandidates = comma ? lambda : lambda + static_cast<int>(population.size());
+        auto candidate = [&](int c) -> std::pair<Instance &, Fitness &> {
+            if (c < lambda) return {offspring[c], offspringFits[c]};
+            return {population[c - lambda], fits[c - lambda]};
+        };
+        order.resize(numCandidates);
+        for (int c = 0; c < numCandidates; ++c) order[c] = c;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return candidate(a).second < candidate(b).second; });
+
+        // Keep the best distinct candidates, filling up with duplicates if there are too few:
+        int kept = 0;
+        int accepted = 0;
+        nextFits.clear();
+        selected.clear();
+        for (int pass = 0; pass < 2 && kept < size; ++pass) {
+            for (int c : order) {
+                if (kept >= size) break;
+                BackdoorRef key = candidate(c).first.key();
+                bool duplicate = std::any_of(selected.begin(), selected.end(), [&](const BackdoorKey &s) { return s.matches(key); });
+                if (duplicate != (pass == 1)) continue;
+                if (pass == 0) selected.emplace_back(key);
+                if (c < lambda) accepted++;
+                if (kept < static_cast<int>(nextPopulation.size())) {
+                    nextPopulation[kept] = candidate(c).first;
+                } else {
+                    nextPopulation.push_back(candidate(c).first);
+                }
+                nextFits.push_back(candidate(c).second);
+                kept++;
+            }
+        }
+        nextPopulation.erase(nextPopulation.begin() + kept, nextPopulation.end());
+        population.swap(nextPopulation);
+        fits.swap(nextFits);
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        if (telemetry) {
+            IterationSample sample;
+            sample.iteration = i;
+            sample.seconds = std::chrono::duration<double>(endTime - startTime).count();
+            sample.accepted = accepted;
+            sample.improved = improved;
+            sample.fitness = fits.front();
+            sample.numVars = population.front().numVariables();
+            recordIteration(sample, sampled ? &before : nullptr, hitsBefore, missesBefore);
+        }
+        if (i <= 10 || (i < 1000 && i % 100 == 0) || (i < 10000 && i % 1000 == 0) || (i % 10000 == 0)) {
+            *out << "[" << i << "/" << numIterations << "] "
+                 << "Population fitness " << fits.front().fitness
+                 << " (rho=" << fits.front().rho
+                 << ", hard=" << fits.front().hard
+                 << ") to " << std::max_element(fits.begin(), fits.end())->fitness
+                 << ", best for " << population.front().numVariables() << " vars "
+                 << population.front() << " in " << duration.count() << " ms"
+                 << std::endl;
+        }
+
+        if (checkpoint && checkpoint->due() && checkpointIteration(i, population, fits, best, bestFitness, bestIteration)) {
+            break;
+        }
+        if ((stopReason = checkBudget(i, bestIteration)) != StopReason::None) {
+            break;
+        }
+    }
+    return lastIteration;
+}
+
+// Evaluate a generation: duplicates and cached offspring first, then the rest in parallel
+void EvolutionaryAlgorithm::evaluateBatch(std::vector<Instance> &offspring, std::vector<Fitness> &fitness, const Fitness *threshold) {
+    const int n = offspring.size();
+    fitness.assign(n, Fitness{});
+    std::vector<int> &source = batchSource;  // earlier offspring with the same variables
+    std::vector<int> &pending = batchPending;
+    source.assign(n, -1);
+    pending.clear();
+    for (int k = 0; k < n; ++k) {
+        BackdoorRef key = offspring[k].key();
+        for (int j = 0; j < k && source[k] == -1; ++j) {
+            if (source[j] == -1 && key.hash == offspring[j].hash && BackdoorKey(offspring[j].key()).matches(key)) {
+                source[k] = j;
+            }
+        }
+        if (source[k] != -1) {
+            batch_duplicates++;
+        } else if (is_cached(offspring[k], fitness[k], threshold)) {
+            cache_hits++;
+        } else {
+            cache_misses++;
+            pending.push_back(k);
+        }
+    }
+
+    // Sampling seeds are drawn up front, so the results do not depend on the number of threads:
+    std::vector<uint32_t> &seeds = batchSeeds;
+    seeds.assign(pending.size(), 0);
+    if (samples > 0) {
+        for (auto &seed : seeds) seed = gen();
+    }
+    std::vector<char> &rechecked = batchRechecked;
+    rechecked.assign(pending.size(), false);
+    auto task = [&](int worker, int p) {
+        bool r = false;
+        fitness[pending[p]] = evaluateOn(worker, offspring[pending[p]], threshold, seeds[p], r);
+        rechecked[p] = r;
+    };
+    if (batchPool) {
+        batchPool->parallelFor(pending.size(), std::ref(task));  // wrapped without allocating
+    } else {
+        for (size_t p = 0; p < pending.size(); ++p) task(0, p);
+    }
+
+    for (size_t p = 0; p < pending.size(); ++p) {
+        const Fitness &f = fitness[pending[p]];
+        if (f.lowerBound) early_aborts++;
+        if (f.error != 0 || rechecked[p]) estimates++;
+        if (rechecked[p]) exact_rechecks++;
+        crossCheckFitness(offspring[pending[p]], f);
+        cache->insert(offspring[pending[p]].key(), f);
+    }
+    for (int k = 0; k < n; ++k) {
+        if (source[k] != -1) fitness[k] = fitness[source[k]];
+        offspring[k]._cached_fitness = std::make_optional(fitness[k]);
+        if (omega > 0 && source[k] == -1) front.add(offspring[k], fitness[k]);
+    }
+}
+
+// Evaluate one offspring on the given batch worker; safe to call concurrently for distinct workers
+Fitness EvolutionaryAlgorithm::evaluateOn(int worker, Instance &instance, const Fitness *threshold, uint32_t seed, bool &rechecked) {
+    Solver &s = batchPool ? *batchSolvers[worker] : solver;
+    PropEngine *e = batchPool ? (batchEngines.empty() ? nullptr : batchEngines[worker].get()) : engine.get();
+    EvalContext &c = batchPool ? batchContexts[worker] : context;
+    if (samples > 0 && instance.numVariables() > 0 && instance.numVariables() >= sampleMinVars) {
+        std::mt19937 rng(seed);
+        Fitness estimate = e ? instance.estimateFitness(*e, c, samples, sampleConfidence, rng)
+                             : instance.estimateFitness(s, c, samples, sampleConfidence, rng);
+        if (isConclusive(estimate, threshold)) return estimate;
+        rechecked = true;
+    }
+    uint64_t cutoff = UINT64_MAX;
+    if (threshold && instance.numVariables() > 0) {
+        cutoff = hardCutoff(instance, *threshold);
+    }
+    bool tree = !batchPool && usesParallel(instance);  // the tree evaluator is not shared by batch workers
+    if (e && !tree) {
+        return instance.calculateFitness(*e, c, cutoff);
+    }
+    return instance.calculateFitness(s, c, tree ? parallel : nullptr, cutoff);
+}
+
+void EvolutionaryAlgorithm::crossCheckFitness(const Instance &instance, const Fitness &fitness) {
+    if (instance.numVariables() == 0 || instance.numVariables() > crossCheck || !fitness.exact()) return;
+    std::vector<int> &vars = context.vars;
+    instance.getVariables(vars);
+    uint64_t total_count;
+    solver.gen_all_valid_assumptions_propcheck(vars, total_count, Solver::CubeSink());
+    cross_checks++;
+    if (total_count != fitness.hard) {
+        std::cerr << "Cross-check mismatch on " << vars << ": " << fitness.hard << " hard tasks evaluated, "
+                  << total_count << " by enumeration" << std::endl;
+        exit(42);
+    }
+}
+
+bool EvolutionaryAlgorithm::usesParallel(const Instance &instance) const {
+    return parallel && instance.numVariables() >= parallel->minVariables;
+}
+
 // Create an initial individual
 Instance EvolutionaryAlgorithm::initialize(
     int instanceSize,
@@ -164,12 +740,10 @@ Instance EvolutionaryAlgorithm::initialize(
     // std::vector<int> data(instanceSize, -1);
     // Instance instance(std::move(data), std::move(pool));
 
-    std::uniform_real_distribution<double> dis(0.0, 1.0);
-    std::uniform_int_distribution<size_t> dis_pool_index(0, pool.size() - 1);
-    std::vector<int> data(instanceSize, -1);
+    std::vector<int> data(numSlots(instanceSize, pool.size()), -1);
     for (int i = 0; i < instanceSize; ++i) {
         while (data[i] == -1) {
-            size_t j = dis_pool_index(gen);
+            size_t j = pickPoolIndex(pool);
             if (pool[j] != -1) {
                 std::swap(data[i], pool[j]);
             }
@@ -177,14 +751,21 @@ Instance EvolutionaryAlgorithm::initialize(
     }
     pool.erase(std::remove(pool.begin(), pool.end(), -1), pool.end());
     Instance instance(data, pool);
+    instance.omega = omega;
 
     return instance;
 }
 
 // Calculate the fitness value of the individual
-Fitness EvolutionaryAlgorithm::calculateFitness(Instance &instance) {
+Fitness EvolutionaryAlgorithm::calculateFitness(Instance &instance, const std::vector<int> *parent, const Fitness *threshold) {
+    // Hard tasks beyond this count make the instance worse than 'threshold':
+    uint64_t cutoff = UINT64_MAX;
+    if (threshold && !threshold->lowerBound && instance.numVariables() > 0) {
+        cutoff = hardCutoff(instance, *threshold);
+    }
+
     Fitness fitness{};
-    if (!is_cached(instance, fitness)) {
+    if (!is_cached(instance, fitness, threshold)) {
         cache_misses++;
         if (instance._cached_fitness.has_value()) {
             cached_hits++;
@@ -192,11 +773,31 @@ Fitness EvolutionaryAlgorithm::calculateFitness(Instance &instance) {
             cached_misses++;
         }
 
-        // Delegate to instance for computing the fitness:
-        fitness = instance.calculateFitness(solver);
+        // Screen large backdoors by sampling:
+        bool done = false;
+        if (samples > 0 && instance.numVariables() > 0 && instance.numVariables() >= sampleMinVars) {
+            fitness = engine ? instance.estimateFitness(*engine, context, samples, sampleConfidence, gen)
+                             : instance.estimateFitness(solver, context, samples, sampleConfidence, gen);
+            estimates++;
+            done = isConclusive(fitness, threshold);
+            if (!done) exact_rechecks++;
+        }
+
+        // Reuse the prefix shared with the parent, or delegate to instance for computing the fitness:
+        if (!done && !(parent && calculateIncremental(instance, *parent, cutoff, fitness))) {
+            if (engine && !usesParallel(instance)) {
+                fitness = instance.calculateFitness(*engine, context, cutoff);
+            } else {
+                fitness = instance.calculateFitness(solver, context, parallel, cutoff);
+            }
+        }
+        if (fitness.lowerBound) {
+            early_aborts++;
+        }
+        crossCheckFitness(instance, fitness);
 
         // Update global fitness cache:
-        cache.emplace(instance.getVariables(), fitness);
+        cache->insert(instance.key(), fitness);
     } else {
         // std::cout << "cached (global) fitness: " << fitness << std::endl;
         cache_hits++;
@@ -204,21 +805,67 @@ Fitness EvolutionaryAlgorithm::calculateFitness(Instance &instance) {
 
     // Update instance's local cache:
     instance._cached_fitness = std::make_optional(fitness);
+    if (omega > 0) front.add(instance, fitness);
 
     return fitness;
 }
 
+// Evaluate a mutant walking the variables shared with its parent first, using the memoized
+// non-conflicting prefixes of the shared set when available. Returns false if not applicable.
+bool EvolutionaryAlgorithm::calculateIncremental(const Instance &instance, const std::vector<int> &parent, uint64_t cutoff, Fitness &fitness) {
+    const int maxChanged = 2;
+
+    if (!incremental || instance._cached_fitness.has_value()) return false;
+    if (usesParallel(instance)) return false;
+
+    std::vector<int> &shared = context.shared, &changed = context.changed;
+    shared.clear();
+    changed.clear();
+    uint64_t sharedHash = 0;
+    for (int x : instance) {
+        if (x == -1) continue;
+        if (std::find(parent.begin(), parent.end(), x) != parent.end()) {
+            shared.push_back(x);
+            sharedHash ^= zobrist(x);
+        } else {
+            changed.push_back(x);
+        }
+    }
+    if (shared.empty() || changed.empty() || changed.size() > maxChanged || shared.size() >= 64) return false;
+    std::sort(shared.begin(), shared.end());
+    std::sort(changed.begin(), changed.end());
+
+    BackdoorRef key{shared.data(), shared.size(), static_cast<int>(shared.size()), sharedHash};
+    uint64_t total_count;
+    bool complete;
+    if (const std::vector<uint64_t> *alive = incremental->find(key)) {
+        complete = engine ? engine->gen_all_valid_assumptions_incremental(shared, changed, alive, nullptr, total_count, cutoff)
+                          : solver.gen_all_valid_assumptions_incremental(shared, changed, alive, nullptr, total_count, cutoff);
+    } else {
+        std::vector<uint64_t> *record = &incremental->scratch();
+        complete = engine ? engine->gen_all_valid_assumptions_incremental(shared, changed, nullptr, record, total_count, cutoff)
+                          : solver.gen_all_valid_assumptions_incremental(shared, changed, nullptr, record, total_count, cutoff);
+        // An aborted walk has not recorded all the prefixes:
+        if (complete) incremental->store(key);
+    }
+
+    fitness = instance.makeFitness(instance.numVariables(), total_count);
+    fitness.lowerBound = !complete;
+    return true;
+}
+
 // Mutate the individual by flipping bits
 void EvolutionaryAlgorithm::mutate(Instance &instance) {
     std::uniform_real_distribution<double> dis(0.0, 1.0);
-    std::uniform_int_distribution<size_t> dis_index(0, instance.pool.size() - 1);
 
+    moves.clear();
     for (size_t i = 0; i < instance.size(); ++i) {
         if (dis(gen) < (1.0 / static_cast<double>(instance.size()))) {
-            size_t j = dis_index(gen);
-            std::swap(instance[i], instance.pool[j]);
+            size_t j = pickPoolIndex(instance.pool);
+            applySwap(instance, i, j);
         }
     }
+    if (omega > 0 && dis(gen) < resizeRate) resize(instance);
 
     // while (instance.numVariables() < 16) {
     //     // std::cout << "numVariables = " << instance.numVariables() << ", swapping..." << std::endl;
@@ -235,13 +882,91 @@ void EvolutionaryAlgorithm::mutate(Instance &instance) {
     // }
 }
 
-bool EvolutionaryAlgorithm::is_cached(const Instance &instance, Fitness &fitness) const {
-    auto it = cache.find(instance.getVariables());
-    if (it != cache.end()) {
-        fitness = it->second;
-        return true;
+// Add a pool variable to a random hole, or remove a random variable, with equal chance
+void EvolutionaryAlgorithm::resize(Instance &instance) {
+    const int size = instance.size();
+    bool grow = instance.numVariables() < size && instance.poolHasVariables();
+    bool shrink = instance.numVariables() > 1;
+    if (grow && shrink) grow = std::uniform_int_distribution<int>(0, 1)(gen) == 0;
+    if (!grow && !shrink) return;
+
+    // The k-th hole or variable:
+    int k = std::uniform_int_distribution<int>(0, grow ? size - instance.numVariables() - 1 : instance.numVariables() - 1)(gen);
+    size_t i = 0;
+    for (;; ++i) {
+        if ((instance[i] == -1) == grow && k-- == 0) break;
+    }
+    size_t j;
+    if (grow) {
+        j = pickPoolIndex(instance.pool);
+        while (instance.pool[j] == -1) j = pickPoolIndex(instance.pool);
+    } else {
+        j = instance.poolHole();
     }
-    return false;
+    applySwap(instance, i, j);
+}
+
+void EvolutionaryAlgorithm::applySwap(Instance &instance, size_t index, size_t poolIndex) {
+    instance.swapWithPool(index, poolIndex);
+    moves.emplace_back(index, poolIndex);
+}
+
+void EvolutionaryAlgorithm::undoMoves(Instance &instance, const Fitness &fitness) {
+    for (auto it = moves.rbegin(); it != moves.rend(); ++it) {
+        instance.swapWithPool(it->first, it->second);
+    }
+    moves.clear();
+    instance._cached_fitness = fitness;
+}
+
+Instance EvolutionaryAlgorithm::withSlots(const Instance &like, const std::vector<int> &slots) const {
+    std::vector<char> taken(solver.nVars(), false);
+    for (int x : slots) {
+        if (x != -1) taken[x] = true;
+    }
+    std::vector<int> pool;
+    for (const std::vector<int> *entries : {&like.data, &like.pool}) {
+        for (int x : *entries) {
+            if (x != -1 && !taken[x]) pool.push_back(x);
+        }
+    }
+    Instance instance(slots, std::move(pool));
+    instance.omega = like.omega;
+    return instance;
+}
+
+size_t EvolutionaryAlgorithm::pickPoolIndex(const std::vector<int> &pool) {
+    std::uniform_int_distribution<size_t> dis_index(0, pool.size() - 1);
+    if (acceptance.empty()) {
+        return dis_index(gen);
+    }
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    for (;;) {
+        size_t j = dis_index(gen);
+        double accept = pool[j] == -1 ? holeAcceptance : acceptance[pool[j]];
+        if (dis(gen) < accept) return j;
+    }
+}
+
+bool EvolutionaryAlgorithm::is_cached(const Instance &instance, Fitness &fitness, const Fitness *threshold) const {
+    if (!cache->find(instance.key(), fitness)) return false;
+    if (fitness.exact()) return true;
+    // A lower bound from a lower cutoff does not tell whether the backdoor enters the front:
+    if (omega > 0 && fitness.lowerBound && fitness.hard <= front.maxHard(instance, instance.numVariables())) return false;
+    return isConclusive(fitness, threshold);
+}
+
+uint64_t EvolutionaryAlgorithm::hardCutoff(const Instance &instance, const Fitness &threshold) const {
+    uint64_t cutoff = instance.hardCutoff(instance.numVariables(), threshold);
+    if (omega > 0) cutoff = std::max(cutoff, front.maxHard(instance, instance.numVariables()));
+    return cutoff;
+}
+
+// A lower bound is conclusive once it is worse than 'threshold'. So is an estimate whose whole
+// confidence interval is, or any estimate when exact rechecks are disabled.
+bool EvolutionaryAlgorithm::isConclusive(const Fitness &fitness, const Fitness *threshold) const {
+    if (fitness.error != 0 && !sampleRecheck) return true;
+    return threshold && fitness.fitness - fitness.error > threshold->fitness;
 }
 
 }  // namespace Minisat
@@ -1,56 +1,236 @@
 #ifndef EA_H
 #define EA_H
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
 #include <random>
 #include <set>
-#include <unordered_map>
 #include <vector>
 
+#include "minisat/core/Budget.h"
 #include "minisat/core/Fitness.h"
+#include "minisat/core/FitnessCache.h"
+#include "minisat/core/IncrementalMemo.h"
 #include "minisat/core/Instance.h"
+#include "minisat/core/ParetoFront.h"
+#include "minisat/core/ResultWriter.h"
 #include "minisat/core/Solver.h"
+#include "minisat/core/Telemetry.h"
+#include "minisat/utils/ThreadPool.h"
 
 namespace Minisat {
 
 class Solver;
+class Checkpoint;
+class ParallelTreeEvaluator;
+class PropEngine;
+class SearchStrategy;
 
 struct Instance;
-
-struct VectorHasher {
-    template <typename T>
-    std::size_t operator()(const std::vector<T> &vec) const {
-        std::size_t seed = vec.size();
-        for (const auto &value : vec) {
-            seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        }
-        return seed;
-    }
-};
+struct RunState;
 
 class EvolutionaryAlgorithm {
    public:
-    virtual ~EvolutionaryAlgorithm() = default;
+    virtual ~EvolutionaryAlgorithm();
+
+    // 'cache' may be shared between several EAs; by default each EA gets its own unbounded one.
+    explicit EvolutionaryAlgorithm(Solver &solver, int seed = -1, std::shared_ptr<FitnessCache> cache = nullptr);
 
-    explicit EvolutionaryAlgorithm(Solver &solver, int seed = -1);
+    Instance run(int numIterations, int instanceSize, std::vector<int> pool, ResultWriter &results, int seed = -1);
+    Instance run(int numIterations, int instanceSize, std::vector<int> pool, std::ostream &backdoorOut, int seed = -1);
 
-    Instance run(int numIterations, int instanceSize, std::vector<int> pool, const char* backdoor_path, int seed = -1);
+    // Seed for the given (1-based) run, derived deterministically from the job seed:
+    static int runSeed(int seed, int run);
+
+    // Evaluate the offspring of a generation on 'numThreads' copies of the solver
+    void setBatchThreads(int numThreads);
+
+    // State to start the given (1-based) run from: the generator and the counters
+    [[nodiscard]] RunState pendingState(int run) const;
 
     std::mt19937 gen;
     Solver &solver;
-    std::unordered_map<std::vector<int>, Fitness, VectorHasher> cache;
+    std::ostream *out = &std::cout;            // progress log
+    ParallelTreeEvaluator *parallel = nullptr;  // optional evaluator for large backdoors
+    std::unique_ptr<IncrementalMemo> incremental;  // optional memo for evaluating mutants incrementally
+    std::shared_ptr<FitnessCache> cache;
+    bool earlyAbort = true;  // stop evaluating mutants as soon as they are known to be worse
+    bool usePropEngine = true;  // evaluate on a 'PropEngine' built from the solver at the start of each run
+    int bitLevels = 6;  // bottom tree levels the engine evaluates bit-parallel, at most PropEngine::MaxBitLevels
+    bool dynamicOrder = false;  // let the engine choose the branching variable per tree node
+    // Let the engine count independent parts of the residual formula separately at tree nodes with
+    // at least this many backdoor variables left (0 = off)
+    int components = 0;
+    bool printTreeShape = false;  // print the nodes per level of the best backdoor's tree after each run
+    // Exact evaluations of backdoors of up to 'crossCheck' variables are recounted by enumerating all
+    // cubes ('gen_all_valid_assumptions_propcheck'); a different count is fatal
+    int crossCheck = 0;
+    // Format of the results written at the end of each run, and the most hard cubes of the best
+    // backdoor written with it (0 = none; more hard cubes are not written)
+    ResultFormat resultFormat = ResultFormat::Text;
+    uint64_t exportCubes = 0;
+    // Sampled estimates for backdoors of at least 'sampleMinVars' variables ('samples' = 0 means exact only):
+    uint64_t samples = 0;
+    int sampleMinVars = 32;
+    double sampleConfidence = 0.95;
+    bool sampleRecheck = true;  // count exactly unless the estimate is clearly worse than the current instance
+    // Generational mode: 'lambda' offspring per generation from a population of 'mu' with (mu+lambda)
+    // selection, or (mu,lambda) if 'comma'. The default mu = lambda = 1 is the (1+1) EA.
+    int mu = 1;
+    int lambda = 1;
+    bool comma = false;
+    // Optional local search run instead of the (1+1) EA (not combined with the generational mode)
+    std::unique_ptr<SearchStrategy> strategy;
+    // Variable-size search: with 'omega' > 0, instances get 'maxSize' slots of which the initial
+    // 'instanceSize' hold variables, and are compared by the size-aware fitness of
+    // 'Instance::makeFitness'. After the swaps of a mutation, a variable is added to a hole or
+    // removed (at random) with probability 'resizeRate'. The exact evaluations of each run are
+    // collected in 'front'.
+    double omega = 0;
+    int maxSize = 0;  // 0 = twice the instance size
+    double resizeRate = 0.5;
+    ParetoFront front;
+    // Per-variable scores (see 'propagationScores') biasing the variables drawn by initialization
+    // and mutation: a variable is drawn with weight (1 - scoreBias) + scoreBias * score / max score.
+    std::vector<double> varScores;
+    double scoreBias = 0;
+    // Optional checkpoint: the state of run 'runNumber' is restored from it at the start of the run,
+    // and saved to it every 'checkpoint->interval' and when it is interrupted. An interrupted run
+    // stops after the current iteration and sets 'interrupted'; its result is then incomplete.
+    Checkpoint *checkpoint = nullptr;
+    int runNumber = 1;
+    bool interrupted = false;
+    // Each run stops at 'numIterations' or at the first limit of 'runBudget' or 'jobBudget' it
+    // reaches, checked after every iteration. 'jobUsage' is shared by all runs of the job.
+    Budget runBudget;
+    Budget jobBudget;
+    std::shared_ptr<BudgetUsage> jobUsage;
+    StopReason stopReason = StopReason::None;  // why the last run stopped
+    Fitness lastFitness{};  // of the backdoor returned by the last completed run
+    const std::atomic<bool> *cancel = nullptr;  // once set, runs stop after the current iteration
+    Telemetry *telemetry = nullptr;  // optional per-iteration records and per-run summaries
     int cache_hits = 0;
     int cache_misses = 0;
     int cached_hits = 0;
     int cached_misses = 0;
+    int early_aborts = 0;
+    int estimates = 0;
+    int exact_rechecks = 0;
+    int batch_duplicates = 0;
+    int cross_checks = 0;
+
+    struct WorkCounters {
+        uint64_t propagations = 0;
+        uint64_t nodes = 0;
+        uint64_t conflicts = 0;
+    };
+
+    // Work of the solver and the engines this EA evaluates on ('nodes' and 'conflicts' of the engines only)
+    [[nodiscard]] WorkCounters workCounters() const;
 
    private:
+    friend class SearchStrategy;
+
     Instance initialize(int numVariables, std::vector<int> pool);
 
-    Fitness calculateFitness(Instance &individual);
+    [[nodiscard]] bool isGenerational() const {
+        return mu > 1 || lambda > 1 || comma;
+    }
+
+    // Returns the last iteration performed
+    int evolveGenerations(int numIterations, int instanceSize, const std::vector<int> &pool, std::vector<Instance> &population,
+                          std::vector<Fitness> &fits, Instance &best, Fitness &bestFitness, int &bestIteration, int firstIteration);
+
+    // Limit reached after 'iteration', or 'None'; also adds the usage since the last check to 'jobUsage'
+    StopReason checkBudget(int iteration, int bestIteration);
+
+    // Adds the iteration to the run histogram, and records it if 'before' (the counters at its start) is given
+    void recordIteration(IterationSample &sample, const WorkCounters *before, int hitsBefore, int missesBefore);
 
+    // Saves the state after 'iteration'; true if the run is to stop
+    bool checkpointIteration(int iteration, const std::vector<Instance> &population, const std::vector<Fitness> &fits,
+                             const Instance &best, const Fitness &bestFitness, int bestIteration);
+
+    void evaluateBatch(std::vector<Instance> &offspring, std::vector<Fitness> &fitness, const Fitness *threshold);
+
+    Fitness evaluateOn(int worker, Instance &instance, const Fitness *threshold, uint32_t seed, bool &rechecked);
+
+    // Recounts the hard tasks of an exact 'fitness' of 'instance' if 'crossCheck' applies
+    void crossCheckFitness(const Instance &instance, const Fitness &fitness);
+
+    // Whether the cube tree of 'instance' is walked by 'parallel'
+    [[nodiscard]] bool usesParallel(const Instance &instance) const;
+
+    // With 'threshold', the result may be a lower bound if it is known to be worse than 'threshold'.
+    // 'parent' are the slots of the instance 'individual' was mutated from, for incremental evaluation.
+    Fitness calculateFitness(Instance &individual, const std::vector<int> *parent = nullptr, const Fitness *threshold = nullptr);
+
+    bool calculateIncremental(const Instance &individual, const std::vector<int> &parent, uint64_t cutoff, Fitness &fitness);
+
+    // Mutate in place, recording the swaps in 'moves'
     void mutate(Instance &mutatedIndividual);
 
-    bool is_cached(const Instance &instance, Fitness &fitness) const;
+    void resize(Instance &instance);
+
+    // Swap applied in place and recorded in 'moves'
+    void applySwap(Instance &instance, size_t index, size_t poolIndex);
+
+    // Undo the swaps in 'moves'; 'fitness' is that of the instance before them
+    void undoMoves(Instance &instance, const Fitness &fitness);
+
+    // 'like' with 'slots' as its slots, and the rest of its variables as its pool
+    [[nodiscard]] Instance withSlots(const Instance &like, const std::vector<int> &slots) const;
+
+    // Slots of the instances of a run from a pool of 'poolSize' variables
+    [[nodiscard]] int numSlots(int instanceSize, size_t poolSize) const {
+        if (omega <= 0) return instanceSize;
+        int slots = maxSize > 0 ? maxSize : 2 * instanceSize;
+        return std::max(instanceSize, static_cast<int>(std::min<size_t>(slots, poolSize)));
+    }
+
+    // Index of a pool entry, uniformly or weighted by 'acceptance', by rejection sampling
+    size_t pickPoolIndex(const std::vector<int> &pool);
+
+    bool is_cached(const Instance &instance, Fitness &fitness, const Fitness *threshold) const;
+    // Hard tasks beyond which 'instance' is worse than 'threshold' and, with omega, can not enter
+    // the front either
+    uint64_t hardCutoff(const Instance &instance, const Fitness &threshold) const;
+
+    // Whether an inexact 'fitness' is good enough to compare against 'threshold'
+    [[nodiscard]] bool isConclusive(const Fitness &fitness, const Fitness *threshold) const;
+
+    EvalContext context;                   // scratch of the evaluations on 'solver' and 'engine'
+    std::vector<EvalContext> batchContexts;  // one per batch worker
+    // Scratch of 'evaluateBatch':
+    std::vector<int> batchSource, batchPending;
+    std::vector<uint32_t> batchSeeds;
+    std::vector<char> batchRechecked;
+
+    // The (1+1) loop mutates the current instance in place and undoes rejected mutations, so its
+    // iterations do not copy the pool:
+    std::vector<std::pair<size_t, size_t>> moves;  // (slot, pool index) swaps of the current mutation
+    std::vector<int> parent;                       // slots of the current instance before the mutation
+
+    // Budget accounting of the current run:
+    std::chrono::steady_clock::time_point run_start;
+    uint64_t run_evaluations = 0;   // 'cache_misses' at the start of the run
+    uint64_t run_propagations = 0;  // 'workCounters()' at the start of the run
+    uint64_t checked_evaluations = 0;
+    uint64_t checked_propagations = 0;
+
+    // Telemetry of the current run: the counters at its start, and the histograms
+    RunSummary run_summary;
+
+    std::vector<double> acceptance;  // per variable: chance to accept a drawn pool entry (empty: uniform)
+    double holeAcceptance = 1;
+
+    std::unique_ptr<PropEngine> engine;
+    std::vector<std::unique_ptr<Solver>> batchSolvers;  // solver copies for 'evaluateBatch'
+    std::vector<std::unique_ptr<PropEngine>> batchEngines;
+    std::unique_ptr<ThreadPool> batchPool;
 };
 
 }  // namespace Minisat
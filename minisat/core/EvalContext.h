@@ -0,0 +1,29 @@
+#ifndef EVALCONTEXT_H
+#define EVALCONTEXT_H
+
+#include <cstddef>
+#include <vector>
+
+namespace Minisat {
+
+// Scratch buffers of the fitness evaluations on one solver or engine.
+//
+// An EA keeps one context for its own evaluations and one per batch worker, so no two threads
+// share one. The buffers are sized to the largest backdoor at the start of every run and only
+// cleared afterwards; evaluating a backdoor then allocates nothing. (The solver and the engine
+// keep their own walk scratch likewise.)
+struct EvalContext {
+    std::vector<int> vars;     // variables of the evaluated backdoor, sorted
+    std::vector<int> shared;   // incremental evaluation: the variables shared with the parent,
+    std::vector<int> changed;  // and the others
+
+    void reserve(size_t maxVars) {
+        vars.reserve(maxVars);
+        shared.reserve(maxVars);
+        changed.reserve(maxVars);
+    }
+};
+
+}  // namespace Minisat
+
+#endif
@@ -9,6 +9,12 @@ struct Fitness {
     double fitness;
     double rho;
     uint64_t hard;
+    bool lowerBound = false;  // evaluation stopped early: 'fitness' and 'hard' are lower bounds
+    double error = 0;         // half-width of the confidence interval of a sampled estimate (0 if exact)
+
+    [[nodiscard]] bool exact() const {
+        return !lowerBound && error == 0;
+    }
 
     bool operator<(const Fitness &other) const {
         return fitness < other.fitness;
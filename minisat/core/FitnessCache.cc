@@ -0,0 +1,192 @@
+#include "minisat/core/FitnessCache.h"
+
+#include <algorithm>
+
+namespace Minisat {
+
+FitnessCache::FitnessCache(size_t maxBytes, int numShards) {
+    if (numShards < 1) numShards = 1;
+    for (int i = 0; i < numShards; ++i) {
+        shards.emplace_back(new Shard);
+        shards.back()->table.assign(64, Empty);
+    }
+    maxShardBytes = maxBytes == 0 ? 0 : std::max<size_t>(1, maxBytes / numShards);
+}
+
+// Per-entry footprint: the slot, its share of the bucket table and out-of-line key storage.
+size_t FitnessCache::entryBytes(const BackdoorKey &key) {
+    return sizeof(Slot) + 2 * sizeof(uint32_t) + key.heapBytes();
+}
+
+FitnessCache::Shard &FitnessCache::shardFor(uint64_t hash) {
+    // The low bits select the shard, the higher ones the bucket inside it.
+    return *shards[(hash & 0x7F) % shards.size()];
+}
+
+size_t FitnessCache::Shard::lookup(const BackdoorRef &key) const {
+    size_t mask = table.size() - 1;
+    for (size_t b = bucket(key.hash);; b = (b + 1) & mask) {
+        if (table[b] == Empty || slots[table[b]].key.matches(key)) return b;
+    }
+}
+
+// Backward-shift deletion keeps the probe sequences intact without tombstones.
+void FitnessCache::Shard::erase(size_t b) {
+    size_t mask = table.size() - 1;
+    size_t hole = b;
+    for (size_t next = (b + 1) & mask; table[next] != Empty; next = (next + 1) & mask) {
+        size_t home = bucket(slots[table[next]].key.hash());
+        // Move 'next' into the hole unless its home lies cyclically within (hole, next]:
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            table[hole] = table[next];
+            hole = next;
+        }
+    }
+    table[hole] = Empty;
+}
+
+void FitnessCache::Shard::grow() {
+    std::vector<uint32_t> old(table.size() * 2, Empty);
+    old.swap(table);
+    size_t mask = table.size() - 1;
+    for (uint32_t index : old) {
+        if (index == Empty) continue;
+        size_t b = bucket(slots[index].key.hash());
+        while (table[b] != Empty) b = (b + 1) & mask;
+        table[b] = index;
+    }
+}
+
+bool FitnessCache::lookup(const BackdoorRef &key, Fitness &fitness) {
+    Shard &shard = shardFor(key.hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_t b = shard.lookup(key);
+    if (shard.table[b] == Empty) return false;
+    Slot &slot = shard.slots[shard.table[b]];
+    slot.referenced = true;
+    fitness = slot.fitness;
+    return true;
+}
+
+bool FitnessCache::find(const BackdoorRef &key, Fitness &fitness) {
+    // Stored values may have been appended by other processes since the last load:
+    if (lookup(key, fitness) || (store && store->load(*this) && lookup(key, fitness))) {
+        num_hits++;
+        return true;
+    }
+    num_misses++;
+    return false;
+}
+
+void FitnessCache::insert(const BackdoorRef &key, const Fitness &fitness, bool persist) {
+    Shard &shard = shardFor(key.hash);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+
+    size_t b = shard.lookup(key);
+    if (shard.table[b] != Empty) {
+        Slot &slot = shard.slots[shard.table[b]];
+        bool upgrade = fitness.exact() && !slot.fitness.exact();
+        // Never replace an exact value by a lower bound or an estimate:
+        if (fitness.exact() || !slot.fitness.exact()) {
+            slot.fitness = fitness;
+        }
+        slot.referenced = true;
+        lock.unlock();
+        if (upgrade && persist) persistExact(key, fitness);
+        return;
+    }
+
+    BackdoorKey owned(key);
+    size_t need = entryBytes(owned);
+    if (maxShardBytes != 0) {
+        if (need > maxShardBytes) {
+            lock.unlock();
+            if (fitness.exact() && persist) persistExact(key, fitness);
+            return;
+        }
+        bool evicted = false;
+        while (shard.bytes + need > maxShardBytes && shard.count > 0) {
+            evictOne(shard);
+            evicted = true;
+        }
+        if (evicted) b = shard.lookup(key);
+    }
+    if ((shard.count + 1) * 10 > shard.table.size() * 7) {
+        shard.grow();
+        b = shard.lookup(key);
+    }
+
+    uint32_t index;
+    if (!shard.free.empty()) {
+        index = shard.free.back();
+        shard.free.pop_back();
+    } else {
+        index = shard.slots.size();
+        shard.slots.emplace_back();
+    }
+    // New entries start unreferenced: they survive one sweep of the hand only if they get hit.
+    shard.slots[index] = Slot{std::move(owned), fitness, true, false};
+    shard.table[b] = index;
+    shard.count++;
+    shard.bytes += need;
+    lock.unlock();
+    if (fitness.exact() && persist) persistExact(key, fitness);
+}
+
+void FitnessCache::persistExact(const BackdoorRef &key, const Fitness &fitness) {
+    if (store) store->append(key, fitness);
+    if (onPersist) onPersist(key, fitness);
+}
+
+void FitnessCache::evictOne(Shard &shard) {
+    for (;;) {
+        if (shard.hand >= shard.slots.size()) shard.hand = 0;
+        uint32_t index = shard.hand++;
+        Slot &slot = shard.slots[index];
+        if (!slot.used) continue;
+        if (slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        BackdoorRef ref{slot.key.begin(), static_cast<size_t>(slot.key.size()), slot.key.size(), slot.key.hash()};
+        shard.erase(shard.lookup(ref));
+        shard.bytes -= entryBytes(slot.key);
+        slot = Slot{BackdoorKey(), Fitness{}, false, false};
+        shard.free.push_back(index);
+        shard.count--;
+        num_evictions++;
+        return;
+    }
+}
+
+void FitnessCache::clear() {
+    for (auto &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->table.assign(64, Empty);
+        shard->slots.clear();
+        shard->free.clear();
+        shard->count = 0;
+        shard->hand = 0;
+        shard->bytes = 0;
+    }
+}
+
+size_t FitnessCache::size() const {
+    size_t total = 0;
+    for (auto &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->count;
+    }
+    return total;
+}
+
+size_t FitnessCache::bytes() const {
+    size_t total = 0;
+    for (auto &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->bytes;
+    }
+    return total;
+}
+
+}  // namespace Minisat
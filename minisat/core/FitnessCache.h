@@ -0,0 +1,92 @@
+#ifndef FITNESSCACHE_H
+#define FITNESSCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "minisat/core/BackdoorKey.h"
+#include "minisat/core/Fitness.h"
+#include "minisat/core/FitnessStore.h"
+
+namespace Minisat {
+
+// Thread-safe fitness cache keyed by backdoor variable sets.
+//
+// The cache is split into independently locked shards. Each shard stores its entries in a slot
+// array indexed by an open-addressing (linear probing) hash table, so neither lookups nor
+// inserts of inline keys allocate in steady state. When a memory limit is given, each shard
+// keeps to its part of it by evicting entries with the CLOCK (second chance) policy.
+//
+// An optional 'FitnessStore' backs the cache across invocations: misses reload it, and new
+// exact values are appended to it.
+class FitnessCache {
+   public:
+    // 'maxBytes' = 0 means unbounded.
+    explicit FitnessCache(size_t maxBytes = 0, int numShards = 16);
+
+    bool find(const BackdoorRef &key, Fitness &fitness);
+    // Replaces the value of an existing entry, unless that would turn an exact value into an inexact one.
+    // With 'persist', a new exact value is also appended to the store.
+    void insert(const BackdoorRef &key, const Fitness &fitness, bool persist = true);
+    void clear();
+
+    void attachStore(std::shared_ptr<FitnessStore> persistent) { store = std::move(persistent); }
+
+    // Called with every new exact value inserted with 'persist', outside the shard locks (so
+    // possibly concurrently), e.g. to pass the entries on to other processes
+    std::function<void(const BackdoorRef &, const Fitness &)> onPersist;
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t bytes() const;  // estimated memory used by the entries
+
+    [[nodiscard]] uint64_t hits() const { return num_hits; }
+    [[nodiscard]] uint64_t misses() const { return num_misses; }
+    [[nodiscard]] uint64_t evictions() const { return num_evictions; }
+
+   private:
+    static constexpr uint32_t Empty = UINT32_MAX;
+
+    struct Slot {
+        BackdoorKey key;
+        Fitness fitness;
+        bool used;
+        bool referenced;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::vector<uint32_t> table;  // slot indices, 'Empty' for a free bucket
+        std::vector<Slot> slots;
+        std::vector<uint32_t> free;
+        size_t count = 0;
+        size_t hand = 0;
+        size_t bytes = 0;
+
+        [[nodiscard]] size_t bucket(uint64_t hash) const { return (hash >> 7) & (table.size() - 1); }
+        size_t lookup(const BackdoorRef &key) const;  // bucket holding 'key', or of the first hole
+        void erase(size_t bucket);
+        void grow();
+    };
+
+    static size_t entryBytes(const BackdoorKey &key);
+    Shard &shardFor(uint64_t hash);
+    void evictOne(Shard &shard);
+
+    bool lookup(const BackdoorRef &key, Fitness &fitness);
+    void persistExact(const BackdoorRef &key, const Fitness &fitness);  // to the store and to 'onPersist'
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t maxShardBytes;
+    std::shared_ptr<FitnessStore> store;
+    std::atomic<uint64_t> num_hits{0};
+    std::atomic<uint64_t> num_misses{0};
+    std::atomic<uint64_t> num_evictions{0};
+};
+
+}  // namespace Minisat
+
+#endif
@@ -0,0 +1,151 @@
+#include "minisat/core/FitnessStore.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "minisat/core/FitnessCache.h"
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+namespace {
+
+constexpr uint32_t Magic = 0x52534145;  // "EASR"
+
+// Fixed part of a record; followed by 'count' sorted variables and a checksum of all of it
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t formula;
+    uint64_t hard;
+    double fitness;
+    double rho;
+};
+
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// FNV-1a
+uint64_t checksum(const char *data, size_t size) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+}  // namespace
+
+FitnessStore::FitnessStore(std::string path, uint64_t formulaHash) : path(std::move(path)), formula(formulaHash) {
+    fd = open(this->path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+}
+
+FitnessStore::~FitnessStore() {
+    if (fd != -1) close(fd);
+}
+
+bool FitnessStore::load(FitnessCache &cache) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd == -1) return false;
+    auto now = std::chrono::steady_clock::now();
+    if (!first && now - last_load < refresh) return false;
+    first = false;
+    last_load = now;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) <= offset) return false;
+    buffer.resize(st.st_size - offset);
+    size_t got = 0;
+    while (got < buffer.size()) {
+        ssize_t n = pread(fd, buffer.data() + got, buffer.size() - got, offset + got);
+        if (n <= 0) break;
+        got += n;
+    }
+
+    bool any = false;
+    size_t pos = 0;
+    std::vector<int> vars;
+    while (pos + sizeof(RecordHeader) <= got) {
+        RecordHeader header;
+        std::memcpy(&header, buffer.data() + pos, sizeof(header));
+        if (header.magic != Magic) break;
+        size_t length = sizeof(header) + header.count * sizeof(int32_t) + sizeof(uint64_t);
+        if (pos + length > got) break;  // still being written, or truncated
+        uint64_t check;
+        std::memcpy(&check, buffer.data() + pos + length - sizeof(check), sizeof(check));
+        if (check != checksum(buffer.data() + pos, length - sizeof(check))) break;
+
+        if (header.formula == formula) {
+            vars.resize(header.count);
+            std::memcpy(vars.data(), buffer.data() + pos + sizeof(header), header.count * sizeof(int32_t));
+            uint64_t hash = 0;
+            for (int v : vars) hash ^= zobrist(v);
+            Fitness fitness{header.fitness, header.rho, header.hard};
+            cache.insert(BackdoorRef{vars.data(), vars.size(), static_cast<int>(vars.size()), hash}, fitness, false);
+            num_loaded++;
+            any = true;
+        }
+        pos += length;
+    }
+    offset += pos;
+    return any;
+}
+
+void FitnessStore::append(const BackdoorRef &key, const Fitness &fitness) {
+    if (fd == -1) return;
+    RecordHeader header{Magic, static_cast<uint32_t>(key.count), formula, fitness.hard, fitness.fitness, fitness.rho};
+    std::vector<int32_t> vars;
+    for (size_t i = 0; i < key.size; ++i) {
+        if (key.data[i] != -1) vars.push_back(key.data[i]);
+    }
+    std::sort(vars.begin(), vars.end());
+
+    std::vector<char> record;
+    auto put = [&](const void *data, size_t size) {
+        const char *bytes = static_cast<const char *>(data);
+        record.insert(record.end(), bytes, bytes + size);
+    };
+    put(&header, sizeof(header));
+    put(vars.data(), vars.size() * sizeof(int32_t));
+    uint64_t check = checksum(record.data(), record.size());
+    put(&check, sizeof(check));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    flock(fd, LOCK_EX);
+    size_t written = 0;
+    while (written < record.size()) {
+        ssize_t n = write(fd, record.data() + written, record.size() - written);
+        if (n <= 0) break;
+        written += n;
+    }
+    flock(fd, LOCK_UN);
+    num_appended++;
+}
+
+uint64_t FitnessStore::formulaHash(const Solver &solver) {
+    uint64_t h = mix(solver.nVars());
+    for (Var v = 0; v < solver.nVars(); ++v) {
+        if (solver.value(v) != l_Undef) h += mix(toInt(mkLit(v, solver.value(v) == l_False)) + 1);
+    }
+    std::vector<int> lits;
+    for (ClauseIterator it = solver.clausesBegin(); it != solver.clausesEnd(); ++it) {
+        const Clause &c = *it;
+        lits.clear();
+        for (int k = 0; k < c.size(); ++k) lits.push_back(toInt(c[k]));
+        std::sort(lits.begin(), lits.end());
+        uint64_t ch = 0;
+        for (int p : lits) ch = mix(ch ^ static_cast<uint64_t>(p + 1));
+        h += mix(ch);
+    }
+    return h;
+}
+
+}  // namespace Minisat
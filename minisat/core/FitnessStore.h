@@ -0,0 +1,63 @@
+#ifndef FITNESSSTORE_H
+#define FITNESSSTORE_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "minisat/core/BackdoorKey.h"
+#include "minisat/core/Fitness.h"
+
+namespace Minisat {
+
+class FitnessCache;
+class Solver;
+
+// Persistent fitness store shared across invocations: an append-only log of exact fitness
+// values, keyed by a hash of the clause database and the backdoor variables.
+//
+// Every record is appended with a single write under an exclusive 'flock', so concurrent
+// processes can share one file. Records of other formulas are skipped when reading, and a
+// truncated or damaged tail ends the log. The file is read lazily into a 'FitnessCache': on the
+// first miss, and again on later misses once the file has grown, at most once per 'refresh'.
+class FitnessStore {
+   public:
+    FitnessStore(std::string path, uint64_t formulaHash);
+    ~FitnessStore();
+
+    FitnessStore(const FitnessStore &) = delete;
+    FitnessStore &operator=(const FitnessStore &) = delete;
+
+    [[nodiscard]] bool isOpen() const { return fd != -1; }
+
+    // Loads the records appended since the last call into 'cache'; true if there were any
+    bool load(FitnessCache &cache);
+
+    void append(const BackdoorRef &key, const Fitness &fitness);
+
+    // Hash of the top-level assignment and the clauses, independent of their order
+    static uint64_t formulaHash(const Solver &solver);
+
+    [[nodiscard]] uint64_t loaded() const { return num_loaded; }
+    [[nodiscard]] uint64_t appended() const { return num_appended; }
+
+    std::chrono::milliseconds refresh{1000};
+
+   private:
+    std::string path;
+    uint64_t formula;
+    int fd = -1;
+    std::mutex mutex;
+    uint64_t offset = 0;  // end of the last complete record read
+    bool first = true;
+    std::chrono::steady_clock::time_point last_load;
+    std::vector<char> buffer;
+    uint64_t num_loaded = 0;
+    uint64_t num_appended = 0;
+};
+
+}  // namespace Minisat
+
+#endif
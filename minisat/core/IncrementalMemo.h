@@ -0,0 +1,74 @@
+#ifndef INCREMENTALMEMO_H
+#define INCREMENTALMEMO_H
+
+#include <cstdint>
+#include <vector>
+
+#include "minisat/core/BackdoorKey.h"
+
+namespace Minisat {
+
+// Memo of cube tree prefixes for incremental fitness evaluation.
+//
+// A mutant usually shares all but one or two variables with its parent. Its cube tree is walked
+// with the shared variables first (sorted), so the top of the tree depends only on the shared
+// set. For a recently seen shared set the memo keeps the sign bitmasks of its non-conflicting
+// nodes at full prefix depth; the walk then visits only those, skipping every conflicting
+// branch of the prefix without propagating it.
+class IncrementalMemo {
+   public:
+    explicit IncrementalMemo(int capacity, size_t maxAlive = 1 << 16) : entries(capacity), maxAlive(maxAlive) {}
+
+    // Alive prefixes of the set 'key', or nullptr if it is not memoized.
+    const std::vector<uint64_t> *find(const BackdoorRef &key) {
+        for (auto &entry : entries) {
+            if (entry.valid && entry.key.matches(key)) {
+                hits++;
+                return &entry.alive;
+            }
+        }
+        misses++;
+        return nullptr;
+    }
+
+    // Scratch vector for recording the alive prefixes of a new set.
+    std::vector<uint64_t> &scratch() {
+        recorded.clear();
+        return recorded;
+    }
+
+    // Store the prefixes recorded in 'scratch()' for 'key', replacing the oldest entry.
+    void store(const BackdoorRef &key) {
+        if (entries.empty() || recorded.size() > maxAlive) return;
+        Entry &entry = entries[next];
+        next = (next + 1) % entries.size();
+        entry.key = BackdoorKey(key);
+        entry.alive.swap(recorded);
+        entry.valid = true;
+    }
+
+    void clear() {
+        for (auto &entry : entries) {
+            entry.valid = false;
+        }
+    }
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+   private:
+    struct Entry {
+        BackdoorKey key;
+        std::vector<uint64_t> alive;
+        bool valid = false;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<uint64_t> recorded;
+    size_t next = 0;
+    size_t maxAlive;
+};
+
+}  // namespace Minisat
+
+#endif
@@ -1,96 +1,162 @@
 #include "minisat/core/Instance.h"
 
+#include <cmath>
+
 #include "minisat/core/Fitness.h"
+#include "minisat/core/ParallelTree.h"
+#include "minisat/core/PropEngine.h"
 
 namespace Minisat {
 
-Fitness Instance::calculateFitness(Solver &solver) {
-    if (_cached_fitness.has_value()) {
+Fitness Instance::calculateFitness(Solver &solver, EvalContext &context, ParallelTreeEvaluator *parallel, uint64_t cutoff) {
+    if (hasCachedFitness(cutoff)) {
         // std::cout << "cached fitness: " << _cached_fitness << std::endl;
         return _cached_fitness.value();
     } else {
         // std::cout << "computing fitness" << std::endl;
 
-        std::vector<int> vars = getVariables();
+        std::vector<int> &vars = context.vars;
+        getVariables(vars);
         // std::cout << "variables: " << vars.size() << std::endl;
 
         if (vars.empty()) {
-            double rho = 0.0;
-            double fitness = std::numeric_limits<double>::max();
-            uint64_t hard = 1 << vars.size();
-            return Fitness{fitness, rho, hard};
+            return emptyFitness();
         }
 
-        if (0) {
-            bool verb = !true;
-
-            // std::cout << "- PROPCHECK" << std::endl;
-            std::vector<std::vector<int>> cubes_pc;
-            uint64_t total_count_pc;
-            solver.gen_all_valid_assumptions_propcheck(vars, total_count_pc, cubes_pc, verb);
-
-            // std::cout << "- TREE" << std::endl;
-            std::vector<std::vector<int>> cubes_tree;
-            uint64_t total_count_tree;
-            solver.gen_all_valid_assumptions_tree(vars, total_count_tree, cubes_tree, 0, verb);
-
-            if (total_count_pc != total_count_tree) {
-                std::cout << "total_count_pc = " << total_count_pc << std::endl;
-                std::cout << "total_count_tree = " << total_count_tree << std::endl;
-                std::cout << "= MISMATCH" << std::endl;
-                exit(42);
-            } else {
-                // std::cout << "total_count_pc = " << total_count_pc << std::endl;
-                // std::cout << "total_count_tree = " << total_count_tree << std::endl;
-                // std::cout << "MATCH" << std::endl;
-            }
+        uint64_t total_count;  // number of hard tasks
+        // solver.gen_all_valid_assumptions_propcheck(vars, total_count, cubes, verb);
+        bool complete;
+        if (parallel && static_cast<int>(vars.size()) >= parallel->minVariables) {
+            complete = parallel->count_valid_assumptions_tree(vars, total_count, cutoff);
+        } else {
+            complete = solver.count_valid_assumptions_tree(vars, total_count, cutoff);
         }
 
-        std::vector<std::vector<int>> cubes;  // hard tasks
-        uint64_t total_count;                 // number of hard tasks
-        bool verb = false;
-        // solver.gen_all_valid_assumptions_propcheck(vars, total_count, cubes, verb);
-        solver.gen_all_valid_assumptions_tree(vars, total_count, cubes, 0, verb);
+        Fitness fitness = makeFitness(vars.size(), total_count);
+        fitness.lowerBound = !complete;
+        return fitness;
+    }
+}
 
-        double omega = 20;
-        double magic = std::pow(2.0, omega);
-        double normalizedSize = static_cast<double>(vars.size()) / static_cast<double>(pool.size());
-        int numValuations = 1 << vars.size();  // 2^|B|
-        // `rho` is the proportion of "easy" tasks:
-        double rho = 1 - static_cast<double>(total_count) / static_cast<double>(numValuations);
-        // std::cout << "rho = " << rho << std::endl;
-        // std::cout << "normalized size = " << normalizedSize << std::endl;
+uint64_t Instance::hardCutoff(size_t numVars, const Fitness &threshold) const {
+    uint64_t lo = 0;
+    uint64_t hi = numVars < 64 ? uint64_t(1) << numVars : UINT64_MAX;
+    if (makeFitness(numVars, hi).fitness <= threshold.fitness) return UINT64_MAX;
+    if (makeFitness(numVars, lo).fitness > threshold.fitness) return 0;
+    // Fitness does not decrease with the number of hard tasks; find the last 'h' in [lo, hi) with fitness <= threshold:
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (makeFitness(numVars, mid).fitness <= threshold.fitness) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
 
-        //! fitness = log2( rho * 2^size + (1-rho) * 2^const )
-        // double fitness = std::log2(rho * numValuations + (1 - rho) * magic);
-        // fitness = rho*2^size + 2^omega - rho*2^omega
-        // fitness = rho*2^size - rho*2^omega
-        // fitness = rho*(2^size - 2^omega)
+Fitness Instance::calculateFitness(PropEngine &engine, EvalContext &context, uint64_t cutoff) {
+    if (hasCachedFitness(cutoff)) {
+        return _cached_fitness.value();
+    }
+    std::vector<int> &vars = context.vars;
+    getVariables(vars);
+    if (vars.empty()) {
+        return emptyFitness();
+    }
+    uint64_t total_count;  // number of hard tasks
+    bool complete = engine.count_valid_assumptions_tree(vars, total_count, cutoff);
+    Fitness fitness = makeFitness(vars.size(), total_count);
+    fitness.lowerBound = !complete;
+    return fitness;
+}
 
-        // fixed
-        // double fitness = std::log2((1 - rho) * numValuations + (1 - rho) * magic);
-        // fitness = (1-rho)*(2^size + 2^omega)
+Fitness Instance::estimateFitness(Solver &solver, EvalContext &context, uint64_t samples, double confidence, std::mt19937 &gen) const {
+    std::vector<int> &vars = context.vars;
+    getVariables(vars);
+    return makeEstimate(vars.size(), solver.sample_valid_assumptions(vars, samples, gen), samples, confidence);
+}
+
+Fitness Instance::estimateFitness(PropEngine &engine, EvalContext &context, uint64_t samples, double confidence, std::mt19937 &gen) const {
+    std::vector<int> &vars = context.vars;
+    getVariables(vars);
+    return makeEstimate(vars.size(), engine.sample_valid_assumptions(vars, samples, gen), samples, confidence);
+}
+
+Fitness Instance::makeEstimate(size_t numVars, uint64_t hits, uint64_t samples, double confidence) const {
+    // Quantile of the standard normal distribution for the two-sided 'confidence' level:
+    double lo = 0, hi = 10;
+    for (int i = 0; i < 64; ++i) {
+        double mid = (lo + hi) / 2;
+        (std::erf(mid / std::sqrt(2.0)) < confidence ? lo : hi) = mid;
+    }
+    double z = hi;
+
+    // Wilson score interval of the proportion of hard tasks:
+    double n = static_cast<double>(samples);
+    double p = static_cast<double>(hits) / n;
+    double denom = 1 + z * z / n;
+    double center = (p + z * z / (2 * n)) / denom;
+    double half = z / denom * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n));
+
+    double numValuations = std::ldexp(1.0, static_cast<int>(numVars));
+    double hard = std::round(p * numValuations);
+    uint64_t total_count = hard < std::ldexp(1.0, 64) ? static_cast<uint64_t>(hard) : UINT64_MAX;
+    Fitness fitness = makeFitness(numVars, p, total_count);
+    fitness.error = std::max(center + half - p, p - (center - half));
+    return fitness;
+}
 
-        // num hard only
-        // double fitness = std::log2((1 - rho) * numValuations);
+Fitness Instance::makeFitness(size_t numVars, uint64_t total_count) const {
+    double numValuations = std::ldexp(1.0, static_cast<int>(numVars));  // 2^|B|, exact in double
+    // Proportion of "hard" tasks, exact for power-of-two denominators:
+    double hardFraction = static_cast<double>(total_count) / numValuations;
+    return makeFitness(numVars, hardFraction, total_count);
+}
+
+Fitness Instance::makeFitness(size_t numVars, double hardFraction, uint64_t total_count) const {
+    double normalizedSize = static_cast<double>(numVars) / static_cast<double>(pool.size());
+    double numValuations = std::ldexp(1.0, static_cast<int>(numVars));  // 2^|B|
+    // `rho` is the proportion of "easy" tasks:
+    double rho = 1 - hardFraction;
+    // std::cout << "rho = " << rho << std::endl;
+    // std::cout << "normalized size = " << normalizedSize << std::endl;
+
+    //! fitness = log2( rho * 2^size + (1-rho) * 2^const )
+    // double fitness = std::log2(rho * numValuations + (1 - rho) * magic);
+    // fitness = rho*2^size + 2^omega - rho*2^omega
+    // fitness = rho*2^size - rho*2^omega
+    // fitness = rho*(2^size - 2^omega)
 
-        // normalized
-        // double fitness = std::log2((1 - rho) * normalizedSize);
+    // fixed
+    // double fitness = std::log2((1 - rho) * numValuations + (1 - rho) * magic);
+    // fitness = (1-rho)*(2^size + 2^omega)
 
-        // multiply (1-rho) and size
-        // double fitness = std::log2(1 + (1 - rho) * vars.size());
+    // num hard only
+    // double fitness = std::log2((1 - rho) * numValuations);
 
-        // mutliply, square
-        // double fitness = std::log2(1 + (1 - rho) * vars.size() * vars.size());
+    // normalized
+    // double fitness = std::log2((1 - rho) * normalizedSize);
 
-        // multiply (1-rho) and number of hard tasks
-        // double fitness = std::log2(1 + (1 - rho) * static_cast<double>(total_count));
+    // multiply (1-rho) and size
+    // double fitness = std::log2(1 + (1 - rho) * numVars);
 
-        // double fitness = std::log2(1 + (1 - rho));
-        double fitness = (1 - rho);
+    // mutliply, square
+    // double fitness = std::log2(1 + (1 - rho) * numVars * numVars);
 
-        return Fitness{fitness, rho, total_count};
+    // multiply (1-rho) and number of hard tasks
+    // double fitness = std::log2(1 + (1 - rho) * static_cast<double>(total_count));
+
+    // double fitness = std::log2(1 + (1 - rho));
+    // fitness = (1 - rho), taken as 'hardFraction' directly: the same value while 1 - rho is exact
+    // (|B| <= 52), and it does not round to zero for large backdoors.
+    double fitness = hardFraction;
+    if (omega > 0) {
+        double magic = std::pow(2.0, omega);
+        fitness = std::log2(rho * numValuations + hardFraction * magic);
     }
+
+    return Fitness{fitness, rho, total_count};
 }
 
 }  // namespace Minisat
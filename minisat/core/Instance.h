@@ -3,29 +3,51 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <ostream>
+#include <random>
 #include <utility>
 #include <vector>
 
+#include "minisat/core/BackdoorKey.h"
+#include "minisat/core/EvalContext.h"
 #include "minisat/core/Fitness.h"
 #include "minisat/core/Solver.h"
 
 namespace Minisat {
 
 class Solver;
+class ParallelTreeEvaluator;
+class PropEngine;
 
 struct Instance {
     std::vector<int> data;
     std::vector<int> pool;
     std::optional<Fitness> _cached_fitness;
+    uint64_t hash = 0;  // Zobrist hash of the variables, kept up to date by 'swapWithPool'
+    int count = 0;      // number of variables (non-hole entries)
+    double omega = 0;   // > 0: fitness accounting for the backdoor size, see 'makeFitness'
+    std::vector<size_t> pool_holes;  // indices of the holes in 'pool', kept up to date by 'swapWithPool'
 
     virtual ~Instance() = default;
 
-    Instance(std::vector<int> data, std::vector<int> pool) : data(std::move(data)), pool(std::move(pool)) {}
+    Instance(std::vector<int> data, std::vector<int> pool) : data(std::move(data)), pool(std::move(pool)) {
+        for (int x : this->data) {
+            if (x != -1) {
+                hash ^= zobrist(x);
+                count++;
+            }
+        }
+        for (size_t j = 0; j < this->pool.size(); ++j) {
+            if (this->pool[j] == -1) pool_holes.push_back(j);
+        }
+    }
 
     // Copy constructor
-    Instance(const Instance &other) : data(other.data), pool(other.pool) {}
+    Instance(const Instance &other)
+        : data(other.data), pool(other.pool), hash(other.hash), count(other.count), omega(other.omega),
+          pool_holes(other.pool_holes) {}
 
     // Copy assignment operator
     Instance &operator=(const Instance &other) {
@@ -33,23 +55,66 @@ struct Instance {
         if (this != &other) {
             data = other.data;  // copy
             pool = other.pool;  // copy
+            hash = other.hash;
+            count = other.count;
+            omega = other.omega;
+            pool_holes = other.pool_holes;
             _cached_fitness = std::nullopt;
         }
         return *this;
     }
 
     [[nodiscard]] int numVariables() const {
-        int count = 0;
-        for (int x : data) {
-            if (x != -1) {
-                count++;
-            }
-        }
         return count;
     }
 
+    // Allocation-free view of the variable set, usable as a cache key
+    [[nodiscard]] BackdoorRef key() const {
+        return BackdoorRef{data.data(), data.size(), count, hash};
+    }
+
+    // Exchange the 'index'-th slot with the 'poolIndex'-th pool entry (its own inverse)
+    void swapWithPool(size_t index, size_t poolIndex) {
+        int &x = data[index];
+        int &y = pool[poolIndex];
+        if (x != -1) hash ^= zobrist(x), count--;
+        if (y != -1) hash ^= zobrist(y), count++;
+        if (x == -1 && y != -1) {
+            pool_holes.push_back(poolIndex);
+        } else if (x != -1 && y == -1) {
+            auto hole = std::find(pool_holes.begin(), pool_holes.end(), poolIndex);
+            *hole = pool_holes.back();
+            pool_holes.pop_back();
+        }
+        std::swap(x, y);
+        _cached_fitness.reset();
+    }
+
+    // Pool index of the first hole, to swap the 'index'-th slot with for removing its variable;
+    // a hole is added to the pool if there is none. There are at most as many holes as slots,
+    // so this does not depend on the pool size.
+    size_t poolHole() {
+        if (pool_holes.empty()) {
+            pool.push_back(-1);
+            pool_holes.push_back(pool.size() - 1);
+        }
+        return *std::min_element(pool_holes.begin(), pool_holes.end());
+    }
+
+    // Whether the pool has a variable left to add
+    [[nodiscard]] bool poolHasVariables() const {
+        return pool_holes.size() < pool.size();
+    }
+
     [[nodiscard]] std::vector<int> getVariables() const {
         std::vector<int> variables;
+        getVariables(variables);
+        return variables;
+    }
+
+    // Same, into 'variables' (keeping its capacity)
+    void getVariables(std::vector<int> &variables) const {
+        variables.clear();
         for (int x : data) {
             if (x != -1) {
                 // Note: variables in MiniSat are 0-based
@@ -58,7 +123,6 @@ struct Instance {
             }
         }
         std::sort(variables.begin(), variables.end());
-        return variables;
     }
 
     [[nodiscard]] std::vector<bool> getBitmask(int numVars) const {
@@ -71,13 +135,44 @@ struct Instance {
         return bits;
     }
 
-    Fitness calculateFitness(Solver &solver);
+    // The evaluation stops once more than 'cutoff' hard tasks are found, see 'Fitness::lowerBound'.
+    // 'context' holds the scratch buffers of the solver or engine evaluated on.
+    Fitness calculateFitness(Solver &solver, EvalContext &context, ParallelTreeEvaluator *parallel = nullptr, uint64_t cutoff = UINT64_MAX);
+    Fitness calculateFitness(PropEngine &engine, EvalContext &context, uint64_t cutoff = UINT64_MAX);
 
-    int operator[](size_t index) const {
-        return data[index];
+    // Estimate from 'samples' random cubes, with the error at the given confidence level
+    Fitness estimateFitness(Solver &solver, EvalContext &context, uint64_t samples, double confidence, std::mt19937 &gen) const;
+    Fitness estimateFitness(PropEngine &engine, EvalContext &context, uint64_t samples, double confidence, std::mt19937 &gen) const;
+
+    // Fitness of this instance given the number of hard tasks of its 'numVars' variables
+    [[nodiscard]] Fitness makeFitness(size_t numVars, uint64_t total_count) const;
+
+    // Fitness of this instance given the proportion of hard tasks of its 'numVars' variables: the
+    // proportion itself, or with 'omega' > 0 the estimated cost log2(rho * 2^|B| + (1 - rho) * 2^omega)
+    // of solving the formula by the backdoor, counting an easy task as 1 and the hard ones as a
+    // fraction of 2^omega. The latter compares backdoors of different sizes, and does not decrease
+    // with the number of hard tasks while |B| <= omega.
+    [[nodiscard]] Fitness makeFitness(size_t numVars, double hardFraction, uint64_t total_count) const;
+
+    // Estimated fitness given 'hits' hard cubes among 'samples' random ones
+    [[nodiscard]] Fitness makeEstimate(size_t numVars, uint64_t hits, uint64_t samples, double confidence) const;
+
+    // Whether '_cached_fitness' answers an evaluation with the given cutoff
+    [[nodiscard]] bool hasCachedFitness(uint64_t cutoff) const {
+        return _cached_fitness.has_value() && (_cached_fitness->exact() || (_cached_fitness->lowerBound && _cached_fitness->hard > cutoff));
     }
 
-    int &operator[](size_t index) {
+    // Fitness of an instance without variables
+    [[nodiscard]] Fitness emptyFitness() const {
+        if (omega > 0) return makeFitness(0, 1.0, 1);
+        return Fitness{std::numeric_limits<double>::max(), 0.0, 1};
+    }
+
+    // Largest number of hard tasks of 'numVars' variables still giving a fitness not worse than
+    // 'threshold' (UINT64_MAX if any number does)
+    [[nodiscard]] uint64_t hardCutoff(size_t numVars, const Fitness &threshold) const;
+
+    int operator[](size_t index) const {
         return data[index];
     }
 
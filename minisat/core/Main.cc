@@ -21,18 +21,39 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <errno.h>
 #include <signal.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <vector>
 #include <set>
 #include <string>
 #include <sstream>
+#include <thread>
 
+#include "minisat/core/BackgroundSearch.h"
+#include "minisat/core/Checkpoint.h"
+#include "minisat/core/ClauseSet.h"
+#include "minisat/core/CnfLoader.h"
+#include "minisat/core/Conquer.h"
 #include "minisat/core/Dimacs.h"
+#include "minisat/core/Distributed.h"
 #include "minisat/core/EA.h"
+#include "minisat/core/FitnessStore.h"
 #include "minisat/core/OutOfMemoryException.h"
+#include "minisat/core/ParallelTree.h"
+#include "minisat/core/Preprocess.h"
+#include "minisat/core/PropEngine.h"
+#include "minisat/core/ResultWriter.h"
+#include "minisat/core/Telemetry.h"
 #include "minisat/core/Solver.h"
+#include "minisat/core/Strategy.h"
+#include "minisat/core/VarScores.h"
 #include "minisat/utils/Options.h"
 #include "minisat/utils/ParseUtils.h"
 #include "minisat/utils/System.h"
@@ -70,6 +91,28 @@ void printStats(Solver &solver) {
     fprintf(stderr, "CPU time              : %g s\n", cpu_time);
 }
 
+// Writes the result in the format of the second command line argument
+static void writeResult(FILE *res, lbool ret, const vec<lbool> &model) {
+    if (ret == l_True) {
+        fprintf(res, "SAT\n");
+        for (int i = 0; i < model.size(); i++)
+            if (model[i] != l_Undef)
+                fprintf(res, "%s%s%d", (i == 0) ? "" : " ", (model[i] == l_True) ? "" : "-", i + 1);
+        fprintf(res, " 0\n");
+    } else if (ret == l_False)
+        fprintf(res, "UNSAT\n");
+    else
+        fprintf(res, "INDET\n");
+    fclose(res);
+}
+
+// The bits of a double, for fingerprints of the options
+static uint64_t doubleBits(double x) {
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(x));
+    return bits;
+}
+
 static Solver *solver;
 #if !(defined(__MINGW32__) || defined(_MSC_VER))
 // Terminate by notifying the solver and back out gracefully. This is mainly to have a test-case
@@ -89,6 +132,14 @@ static void SIGINT_exit(int) {
     }
     _exit(1);
 }
+
+// With a checkpoint, ask the EA to save its state and stop after the current iteration. A
+// second SIGINT quits at once; SIGXCPU repeats until the hard limit and stays graceful.
+static Checkpoint *checkpoint;
+static void SIGINT_checkpoint(int sig) {
+    checkpoint->interrupt();
+    if (sig == SIGINT) signal(SIGINT, SIGINT_exit);
+}
 #endif
 
 std::vector<int> parse_comma_separated_intervals(const std::string& input) {
@@ -146,6 +197,9 @@ int main(int argc, char **argv) {
                           INT32_MAX, IntRange(0, INT32_MAX));
         IntOption mem_lim("MAIN", "mem-lim", "Limit on memory usage in megabytes.\n",
                           INT32_MAX, IntRange(0, INT32_MAX));
+        IntOption parse_threads("MAIN", "parse-threads", "Threads parsing a memory-mapped input file (1 = stream parser, 0 = all cores).\n",
+                                1, IntRange(0, INT32_MAX));
+        StringOption cnf_cache("MAIN", "cnf-cache", "Binary cache of the parsed input file, rewritten when the input changes.\n");
         IntOption ea_seed("EA", "ea-seed", "Seed for EA.\n",
                           42, IntRange(0, INT32_MAX));
         IntOption ea_num_runs("EA", "ea-num-runs", "Number of EA runs.\n",
@@ -157,6 +211,101 @@ int main(int argc, char **argv) {
         StringOption ea_vars("EA", "ea-vars", "Comma-separated list of non-negative 0-based variable indices to use for EA.");
         StringOption ea_bans("EA", "ea-bans", "Comma-separated list of non-negative 0-based variable indices to ban in EA.");
         StringOption ea_output_path("EA", "ea-output-path", "Output file with backdoors found by EA. Each line contains the best backdoor for each EA run.\n", "backdoors.txt");
+        IntOption ea_threads("EA", "ea-threads", "Number of EA runs performed in parallel (each worker uses its own copy of the solver).\n"
+                             "With more than one thread, each run is seeded from '-ea-seed' and the run number.\n",
+                             1, IntRange(1, INT32_MAX));
+        IntOption ea_cache_mb("EA", "ea-cache-mb", "Memory limit of the fitness cache in megabytes (0=unlimited).\n",
+                              0, IntRange(0, INT32_MAX));
+        StringOption ea_store_path("EA", "ea-store-path", "Persistent fitness store shared across invocations (appended to, created if missing).\n");
+        DoubleOption ea_time_limit("EA", "ea-time-limit", "Wall-clock seconds per EA run (0 = unlimited).\n", 0, DoubleRange(0, true, HUGE_VAL, false));
+        Int64Option ea_eval_limit("EA", "ea-eval-limit", "Fitness evaluations missing the cache per EA run (0 = unlimited).\n", 0, Int64Range(0, INT64_MAX));
+        Int64Option ea_prop_limit("EA", "ea-prop-limit", "Propagations per EA run (0 = unlimited).\n", 0, Int64Range(0, INT64_MAX));
+        IntOption ea_stagnation("EA", "ea-stagnation", "Stop an EA run after this many iterations without improvement (0 = never).\n", 0, IntRange(0, INT32_MAX));
+        DoubleOption ea_job_time_limit("EA", "ea-job-time-limit", "Wall-clock seconds for all EA runs (0 = unlimited).\n", 0, DoubleRange(0, true, HUGE_VAL, false));
+        Int64Option ea_job_eval_limit("EA", "ea-job-eval-limit", "Fitness evaluations missing the cache for all EA runs (0 = unlimited).\n", 0, Int64Range(0, INT64_MAX));
+        Int64Option ea_job_prop_limit("EA", "ea-job-prop-limit", "Propagations for all EA runs (0 = unlimited).\n", 0, Int64Range(0, INT64_MAX));
+        StringOption ea_telemetry("EA", "ea-telemetry", "File with machine-readable records of the EA iterations and runs.\n");
+        StringOption ea_telemetry_format("EA", "ea-telemetry-format", "Format of the telemetry file (jsonl, csv).\n", "jsonl");
+        IntOption ea_telemetry_every("EA", "ea-telemetry-every", "Record every n-th iteration in the telemetry file.\n", 1, IntRange(1, INT32_MAX));
+        StringOption ea_checkpoint("EA", "ea-checkpoint", "Checkpoint file with the state of the EA runs, saved periodically and on SIGINT/SIGTERM/SIGXCPU.\n");
+        IntOption ea_checkpoint_interval("EA", "ea-checkpoint-interval", "Seconds between checkpoint saves.\n", 60, IntRange(1, INT32_MAX));
+        BoolOption ea_resume("EA", "ea-resume", "Resume the EA runs from the checkpoint instead of starting afresh.\n", false);
+        BoolOption ea_shared_cache("EA", "ea-shared-cache", "Share one fitness cache between all EA workers.\n", true);
+        IntOption ea_incremental("EA", "ea-incremental", "Number of shared variable sets memoized for incremental evaluation of mutants (0=off).\n",
+                                 32, IntRange(0, INT32_MAX));
+        BoolOption ea_early_abort("EA", "ea-early-abort", "Stop evaluating a mutant once it is known to be worse than the current instance.\n", true);
+        BoolOption ea_preprocess("EA", "ea-preprocess", "Probe failed literals and substitute equivalent literals before building the EA pool.\n", false);
+        DoubleOption ea_score_bias("EA", "ea-score-bias", "Bias initialization and mutation towards variables that propagate more (0 = uniform).\n", 0, DoubleRange(0, true, 1, true));
+        IntOption ea_score_threads("EA", "ea-score-threads", "Number of threads computing the propagation scores (0 = all cores).\n", 0, IntRange(0, INT32_MAX));
+        BoolOption ea_prop_engine("EA", "ea-prop-engine", "Evaluate backdoors on a dedicated propagation engine instead of the solver.\n", true);
+        BoolOption ea_dynamic_order("EA", "ea-dynamic-order", "Choose the branching variable per cube tree node when counting hard tasks.\n", false);
+        IntOption ea_components("EA", "ea-components", "Count the hard tasks of independent parts of the residual formula separately, at cube tree nodes with at least this many backdoor variables left (0 = off).\n", 0, IntRange(0, INT32_MAX));
+#ifdef NDEBUG
+        const int cross_check_default = 0;
+#else
+        const int cross_check_default = 16;
+#endif
+        IntOption ea_cross_check("EA", "ea-cross-check", "Recount the exact evaluations of backdoors up to this size by enumerating all cubes (0 = off).\n",
+                                 cross_check_default, IntRange(0, 30));
+        BoolOption ea_tree_shape("EA", "ea-tree-shape", "Print the number of nodes per level of the best backdoor's cube tree.\n", false);
+        IntOption ea_bit_levels("EA", "ea-bit-levels", "Bottom cube tree levels the propagation engine evaluates bit-parallel (0 = off).\n", PropEngine::MaxBitLevels, IntRange(0, PropEngine::MaxBitLevels));
+        IntOption ea_samples("EA", "ea-samples", "Number of random cubes sampled to estimate the fitness of large backdoors (0=exact only).\n",
+                             0, IntRange(0, INT32_MAX));
+        IntOption ea_sample_min_vars("EA", "ea-sample-min-vars", "Minimal backdoor size for which the fitness is estimated by sampling.\n",
+                                     32, IntRange(1, INT32_MAX));
+        DoubleOption ea_sample_confidence("EA", "ea-sample-confidence", "Confidence level of the error bound of sampled estimates.\n",
+                                          0.95, DoubleRange(0, false, 1, false));
+        BoolOption ea_sample_recheck("EA", "ea-sample-recheck", "Count exactly the hard tasks of backdoors whose estimate is not clearly worse than the current one.\n", true);
+        IntOption ea_mu("EA", "ea-mu", "Population size (mu) of the generational EA.\n", 1, IntRange(1, INT32_MAX));
+        IntOption ea_lambda("EA", "ea-lambda", "Number of offspring (lambda) evaluated as one batch per generation (mu=lambda=1 is the (1+1) EA).\n",
+                            1, IntRange(1, INT32_MAX));
+        BoolOption ea_comma("EA", "ea-comma", "Use (mu,lambda) selection: the next population is chosen from the offspring only.\n", false);
+        IntOption ea_batch_threads("EA", "ea-batch-threads", "Number of threads evaluating the offspring of a generation.\n",
+                                   1, IntRange(1, INT32_MAX));
+        IntOption ea_tree_threads("EA", "ea-tree-threads", "Number of threads evaluating the cube tree of a single (large) backdoor.\n",
+                                  1, IntRange(1, INT32_MAX));
+        IntOption ea_tree_min_vars("EA", "ea-tree-min-vars", "Minimal backdoor size for which the cube tree is evaluated in parallel.\n",
+                                   16, IntRange(0, INT32_MAX));
+        BoolOption ea_cdcl("EA", "ea-cdcl", "Solve the formula by CDCL, searching for backdoors in the background.\n", false);
+        DoubleOption ea_bg_interval("EA", "ea-bg-interval", "Seconds between the clause snapshots taken by CDCL for the background search.\n",
+                                    300, DoubleRange(0, true, HUGE_VAL, false));
+        IntOption ea_bg_runs("EA", "ea-bg-runs", "Number of EA runs on each snapshot in the background search.\n", 100, IntRange(1, INT32_MAX));
+        BoolOption ea_bg_dump_learnts("EA", "ea-bg-dump-learnts", "Write the learnt clauses of each snapshot to 'learnts-<n>.txt'.\n", false);
+        Int64Option ea_learn("EA", "ea-learn", "CDCL conflicts on a copy of the formula to learn clauses for the fitness evaluation (0 = off).\n",
+                             0, Int64Range(0, INT64_MAX));
+        StringOption ea_clauses("EA", "ea-clauses", "Comma-separated files of clauses (DIMACS literals) added for the fitness evaluation, e.g. dumped learnts.\n");
+        IntOption ea_learnt_max_size("EA", "ea-learnt-max-size", "Maximal size of the learnt clauses added for the fitness evaluation (0 = unlimited).\n",
+                                     0, IntRange(0, INT32_MAX));
+        IntOption ea_learnt_max_lbd("EA", "ea-learnt-max-lbd", "Maximal LBD of the learnt clauses added for the fitness evaluation (0 = unlimited).\n",
+                                    0, IntRange(0, INT32_MAX));
+        DoubleOption ea_learnt_activity("EA", "ea-learnt-activity", "Fraction of the most active learnt clauses added for the fitness evaluation.\n",
+                                        1, DoubleRange(0, true, 1, true));
+        BoolOption ea_conquer("EA", "ea-conquer", "After the EA runs, solve the formula by the hard cubes of the best backdoor found.\n", false);
+        IntOption ea_conquer_threads("EA", "ea-conquer-threads", "Number of threads solving the hard cubes (0 = all cores).\n", 0, IntRange(0, INT32_MAX));
+        IntOption ea_conquer_share("EA", "ea-conquer-share", "Maximal size of the learnt clauses shared between the cube solvers (0 = none).\n",
+                                   8, IntRange(0, INT32_MAX));
+        StringOption ea_strategy("EA", "ea-strategy", "Search strategy of the runs: ea (the (1+1) EA), tabu or sa (simulated annealing).\n", "ea");
+        IntOption ea_tabu_tenure("EA", "ea-tabu-tenure", "Iterations a variable swapped out by tabu search can not come back (0 = the instance size).\n",
+                                 0, IntRange(0, INT32_MAX));
+        IntOption ea_neighbours("EA", "ea-neighbours", "Random single-swap neighbours tabu search scans per iteration (0 = all).\n",
+                                16, IntRange(0, INT32_MAX));
+        DoubleOption ea_sa_start("EA", "ea-sa-start", "Initial temperature of simulated annealing.\n", 0.5, DoubleRange(0, false, HUGE_VAL, false));
+        DoubleOption ea_sa_end("EA", "ea-sa-end", "Final temperature of simulated annealing.\n", 0.01, DoubleRange(0, false, HUGE_VAL, false));
+        DoubleOption ea_omega("EA", "ea-omega", "Search backdoors of variable size, compared by log2(rho*2^size + (1-rho)*2^omega) (0 = fixed size).\n",
+                              0, DoubleRange(0, true, 1000, true));
+        IntOption ea_max_size("EA", "ea-max-size", "Maximal backdoor size with -ea-omega (0 = twice the instance size).\n", 0, IntRange(0, INT32_MAX));
+        DoubleOption ea_resize_rate("EA", "ea-resize-rate", "Chance that a mutation with -ea-omega also adds or removes a variable.\n",
+                                    0.5, DoubleRange(0, true, 1, true));
+        StringOption ea_output_format("EA", "ea-output-format", "Format of the backdoor output file (text, jsonl, binary).\n", "text");
+        IntOption ea_output_cubes("EA", "ea-output-cubes", "Write the hard cubes of the best backdoor of a run if there are at most this many (0 = none).\n",
+                                  0, IntRange(0, INT32_MAX));
+        IntOption ea_coordinator("EA", "ea-coordinator", "Hand out the EA runs to '-ea-worker' processes connecting to this TCP port (0 = off, -1 = any free port, printed at startup).\n",
+                                 0, IntRange(-1, 65535));
+        StringOption ea_worker("EA", "ea-worker", "Run the EA runs handed out by the coordinator at <host>:<port>.\n");
+        IntOption ea_top_k("EA", "ea-top-k", "Number of distinct best backdoors the coordinator keeps and writes.\n", 10, IntRange(1, INT32_MAX));
+        IntOption ea_partitions("EA", "ea-partitions", "Number of pool slices the distributed runs draw from in turn.\n", 1, IntRange(1, INT32_MAX));
+        IntOption ea_tree_split("EA", "ea-tree-split", "Number of cube tree levels enumerated up front in parallel evaluation (0=auto).\n",
+                                0, IntRange(0, 30));
 
         parseOptions(argc, argv, true);
 
@@ -208,7 +357,22 @@ int main(int argc, char **argv) {
             fprintf(stderr, "|                                                                             |\n");
         }
 
-        parse_DIMACS(in, S);
+        // The fast paths need a regular input file; otherwise fall back to the stream parser
+        bool parsed = false;
+        if (argc > 1 && (parse_threads != 1 || cnf_cache)) {
+            CnfData cnf;
+            bool cached = cnf_cache && readCnfCache(cnf_cache, argv[1], cnf);
+            int threads = parse_threads > 0 ? (int)parse_threads : (int)std::thread::hardware_concurrency();
+            if (cached || readDimacsMapped(argv[1], threads, cnf)) {
+                if (cnf_cache && !cached && !writeCnfCache(cnf_cache, argv[1], cnf))
+                    fprintf(stderr, "WARNING! Could not write CNF cache: %s\n", (const char *)cnf_cache);
+                addToSolver(cnf, S);
+                parsed = true;
+                if (S.verbosity > 0 && cached)
+                    fprintf(stderr, "|  Loaded from CNF cache                                                      |\n");
+            }
+        }
+        if (!parsed) parse_DIMACS(in, S);
         fclose(in);
         FILE *res = argc >= 3 ? fopen(argv[2], "wb") : stdout;
 
@@ -244,23 +408,227 @@ int main(int argc, char **argv) {
             exit(20);
         }
 
+        // The EA works either on 'S' itself or on a preprocessed copy of it:
+        Solver P;
+        Solver *ea_solver = &S;
+        if (ea_preprocess) {
+            Preprocessor pre(S);
+            bool sat = pre.run(P);
+            if (S.verbosity > 0) {
+                std::cout << "Preprocessing: " << pre.probes << " probes, "
+                          << pre.failed << " failed literals, "
+                          << pre.implied << " implied literals, "
+                          << pre.substituted << " substituted variables, "
+                          << S.nClauses() << " -> " << P.nClauses() << " clauses"
+                          << std::endl;
+            }
+            if (!sat) {
+                if (res != NULL) fprintf(res, "UNSAT\n"), fclose(res);
+                if (S.verbosity > 0) {
+                    fprintf(stderr,
+                            "===============================================================================\n");
+                    fprintf(stderr, "Solved by preprocessing\n");
+                    printStats(S);
+                    fprintf(stderr, "\n");
+                }
+                fprintf(stderr, "UNSATISFIABLE\n");
+                exit(20);
+            }
+            ea_solver = &P;
+        }
+
+        // Backdoors are evaluated against 'ea_solver', or against it with learnt clauses added:
+        Solver L;
+        if (ea_learn > 0 || ea_clauses != NULL) {
+            ClauseSet clause_set(*ea_solver);
+            bool unsat = ea_learn > 0 && clause_set.learn(ea_learn) == l_False;
+            if (ea_clauses != NULL) {
+                std::stringstream paths((const char *)ea_clauses);
+                std::string path, error;
+                while (std::getline(paths, path, ',')) {
+                    if (!clause_set.read(path, error)) {
+                        std::cerr << "Error reading clauses: " << error << std::endl;
+                        return 1;
+                    }
+                }
+            }
+            LearntFilter filter;
+            filter.maxSize = ea_learnt_max_size;
+            filter.maxLbd = ea_learnt_max_lbd;
+            filter.activity = ea_learnt_activity;
+            size_t kept = clause_set.filter(filter);
+            if (unsat || !clause_set.build(L)) {
+                if (res != NULL) fprintf(res, "UNSAT\n"), fclose(res);
+                if (S.verbosity > 0) {
+                    fprintf(stderr,
+                            "===============================================================================\n");
+                    fprintf(stderr, "Solved while learning clauses\n");
+                    printStats(S);
+                    fprintf(stderr, "\n");
+                }
+                fprintf(stderr, "UNSATISFIABLE\n");
+                exit(20);
+            }
+            if (S.verbosity > 0) {
+                std::cout << "Clause set: " << ea_solver->nClauses() << " -> " << L.nClauses() << " clauses, "
+                          << kept << " learnt clauses and " << clause_set.numUnits() << " learnt units added" << std::endl;
+            }
+            ea_solver = &L;
+        }
+
         if (1) {
-            // Truncate the "backdoors" file beforehand:
-            std::ofstream outFile((const char *)ea_output_path, std::ios::out | std::ios::trunc);
+            if (ea_resume && ea_checkpoint == NULL) {
+                std::cerr << "Error: -ea-resume needs -ea-checkpoint" << std::endl;
+                return 1;
+            }
+            std::string strategy = (const char *)ea_strategy;
+            if (strategy != "ea" && strategy != "tabu" && strategy != "sa") {
+                std::cerr << "Unknown search strategy " << strategy << " (ea, tabu or sa)" << std::endl;
+                return 1;
+            }
+            if (strategy != "ea" && (ea_mu > 1 || ea_lambda > 1 || ea_comma)) {
+                std::cerr << "Error: -ea-strategy=" << strategy << " does not combine with -ea-mu, -ea-lambda or -ea-comma" << std::endl;
+                return 1;
+            }
+            if (ea_omega > 0) {
+                int max_size = ea_max_size > 0 ? (int)ea_max_size : 2 * ea_instance_size;
+                if (max_size < ea_instance_size || ea_omega < max_size) {
+                    std::cerr << "Error: -ea-omega needs instance size <= maximal size (" << max_size << ") <= omega" << std::endl;
+                    return 1;
+                }
+            }
+            bool distributed = ea_coordinator != 0 || ea_worker != NULL;
+            if (distributed && (ea_checkpoint != NULL || ea_cdcl || (ea_coordinator != 0 && ea_worker != NULL))) {
+                std::cerr << "Error: -ea-coordinator and -ea-worker exclude each other, -ea-checkpoint and -ea-cdcl" << std::endl;
+                return 1;
+            }
+
+            std::string output_format = (const char *)ea_output_format;
+            if (output_format != "text" && output_format != "jsonl" && output_format != "binary") {
+                std::cerr << "Unknown output format " << output_format << " (text, jsonl or binary)" << std::endl;
+                return 1;
+            }
+            ResultFormat result_format = output_format == "jsonl"    ? ResultFormat::Jsonl
+                                         : output_format == "binary" ? ResultFormat::Binary
+                                                                     : ResultFormat::Text;
+
+            // Truncate the "backdoors" file beforehand (when resuming, back to its size at the checkpoint):
+            std::ofstream outFile((const char *)ea_output_path, ea_resume ? std::ios::app : std::ios::out | std::ios::trunc);
             if (outFile.is_open()) {
                 outFile.close();
             } else {
                 std::cerr << "Error opening the file." << std::endl;
                 return 1;
             }
+            // One stream for all the results of the job:
+            auto results = std::make_shared<ResultWriter>((const char *)ea_output_path);
+            if (!results->isOpen()) {
+                std::cerr << "Error opening the file." << std::endl;
+                return 1;
+            }
 
-            if (1) {
-                auto startTime = std::chrono::high_resolution_clock::now();
-                EvolutionaryAlgorithm ea(S, ea_seed);
+            auto startTime = std::chrono::high_resolution_clock::now();
+            Solver &E = *ea_solver;
+            std::vector<double> scores;  // propagation scores, computed once the pool is known
+            std::shared_ptr<FitnessStore> store;
+            if (ea_store_path != NULL) {
+                // The stored fitness values depend on omega:
+                uint64_t key = FitnessStore::formulaHash(E);
+                if (ea_omega > 0) key = Checkpoint::fingerprint({key, doubleBits(ea_omega)});
+                store = std::make_shared<FitnessStore>((const char *)ea_store_path, key);
+                if (!store->isOpen()) {
+                    std::cerr << "Error opening the fitness store " << (const char *)ea_store_path << std::endl;
+                    return 1;
+                }
+            }
+            auto make_cache = [&]() {
+                auto cache = std::make_shared<FitnessCache>((size_t)ea_cache_mb * 1024 * 1024);
+                cache->attachStore(store);
+                return cache;
+            };
+            std::shared_ptr<FitnessCache> cache = make_cache();
+            Budget run_budget;
+            run_budget.seconds = ea_time_limit;
+            run_budget.evaluations = ea_eval_limit;
+            run_budget.propagations = ea_prop_limit;
+            run_budget.stagnation = ea_stagnation;
+            Budget job_budget;
+            job_budget.seconds = ea_job_time_limit;
+            job_budget.evaluations = ea_job_eval_limit;
+            job_budget.propagations = ea_job_prop_limit;
+            auto job_usage = std::make_shared<BudgetUsage>();
+            std::unique_ptr<Telemetry> telemetry;
+            if (ea_telemetry != NULL) {
+                std::string format = (const char *)ea_telemetry_format;
+                if (format != "jsonl" && format != "csv") {
+                    std::cerr << "Unknown telemetry format " << format << " (jsonl or csv)" << std::endl;
+                    return 1;
+                }
+                telemetry.reset(new Telemetry((const char *)ea_telemetry, format == "csv" ? Telemetry::Format::Csv : Telemetry::Format::Jsonl,
+                                              ea_telemetry_every));
+                if (!telemetry->isOpen()) {
+                    std::cerr << "Error opening the telemetry file " << (const char *)ea_telemetry << std::endl;
+                    return 1;
+                }
+            }
+            int runs_done = 0;
+            auto configure = [&](EvolutionaryAlgorithm &e) {
+                if (ea_incremental > 0) e.incremental.reset(new IncrementalMemo(ea_incremental));
+                e.earlyAbort = ea_early_abort;
+                e.usePropEngine = ea_prop_engine;
+                e.bitLevels = ea_bit_levels;
+                e.dynamicOrder = ea_dynamic_order;
+                e.components = ea_components;
+                e.printTreeShape = ea_tree_shape;
+                e.crossCheck = ea_cross_check;
+                e.resultFormat = result_format;
+                e.exportCubes = ea_output_cubes;
+                e.samples = ea_samples;
+                e.sampleMinVars = ea_sample_min_vars;
+                e.sampleConfidence = ea_sample_confidence;
+                e.sampleRecheck = ea_sample_recheck;
+                e.mu = ea_mu;
+                e.lambda = ea_lambda;
+                e.comma = ea_comma;
+                e.varScores = scores;
+                e.scoreBias = ea_score_bias;
+                e.runBudget = run_budget;
+                e.jobBudget = job_budget;
+                e.jobUsage = job_usage;
+                e.telemetry = telemetry.get();
+                e.omega = ea_omega;
+                e.maxSize = ea_max_size;
+                e.resizeRate = ea_resize_rate;
+                e.setBatchThreads(ea_batch_threads);
+                if (strategy == "tabu") {
+                    auto tabu = new TabuSearch;
+                    tabu->tenure = ea_tabu_tenure;
+                    tabu->neighbours = ea_neighbours;
+                    e.strategy.reset(tabu);
+                } else if (strategy == "sa") {
+                    auto sa = new SimulatedAnnealing;
+                    sa->startTemperature = ea_sa_start;
+                    sa->endTemperature = ea_sa_end;
+                    e.strategy.reset(sa);
+                }
+            };
+            if (!ea_cdcl) {
+                EvolutionaryAlgorithm ea(E, ea_seed, cache);
+                configure(ea);
+
+                // Parallel cube tree evaluation, one evaluator per EA worker:
+                auto make_parallel = [&](const Solver &solver) {
+                    std::unique_ptr<ParallelTreeEvaluator> parallel;
+                    if (ea_tree_threads > 1) {
+                        parallel.reset(new ParallelTreeEvaluator(solver, ea_tree_threads, ea_tree_split));
+                        parallel->minVariables = ea_tree_min_vars;
+                    }
+                    return parallel;
+                };
 
                 // Determine holes in the original CNF:
-                std::vector<bool> hole(S.nVars(), true);
-                for (ClauseIterator it = S.clausesBegin(); it != S.clausesEnd(); ++it) {
+                std::vector<bool> hole(E.nVars(), true);
+                for (ClauseIterator it = E.clausesBegin(); it != E.clausesEnd(); ++it) {
                     const Clause& c = *it;
                     for (int i = 0; i < c.size(); ++i) {
                         Var v = var(c[i]);
@@ -269,7 +637,7 @@ int main(int argc, char **argv) {
                 }
 
                 // Ban the variables passed via '-ea-bans' option:
-                std::vector<bool> banned(S.nVars(), false);
+                std::vector<bool> banned(E.nVars(), false);
                 if (ea_bans != NULL) {
                     std::vector<int> vars = parse_comma_separated_intervals((const char*) ea_bans);
                     for (Var v : vars) {
@@ -284,7 +652,7 @@ int main(int argc, char **argv) {
                     std::vector<int> vars = parse_comma_separated_intervals((const char*) ea_vars);
                     std::copy(vars.begin(), vars.end(), std::inserter(possible_vars, possible_vars.end()));
                 } else {
-                    for (Var v = 0; v < S.nVars(); ++v) {
+                    for (Var v = 0; v < E.nVars(); ++v) {
                         possible_vars.insert(v);
                     }
                 }
@@ -294,7 +662,7 @@ int main(int argc, char **argv) {
 
                 for (Var v : possible_vars) {
                     // Skip the "holes":
-                    if (hole[v] && S.value(v) == l_Undef) {
+                    if (hole[v] && E.value(v) == l_Undef) {
                         if (S.verbosity > 1) {
                             std::cout << "Skipping hole " << v << std::endl;
                         }
@@ -310,11 +678,11 @@ int main(int argc, char **argv) {
                     }
 
                     // Skip already assigned variables:
-                    if (S.value(v) != l_Undef) {
+                    if (E.value(v) != l_Undef) {
                         if (S.verbosity > 1) {
                             std::cout << "Skipping variable " << v
                                       << " already assigned to "
-                                      << (S.value(v).isTrue() ? "TRUE" : "FALSE")
+                                      << (E.value(v).isTrue() ? "TRUE" : "FALSE")
                                       << std::endl;
                         }
                         continue;
@@ -329,67 +697,373 @@ int main(int argc, char **argv) {
                     std::cout << "Pool size: " << pool.size() << std::endl;
                 }
 
-                // Run EA
-                std::cout << "\n=== [" << 1 << "/" << ea_num_runs << "]"
-                          << " -------------------------------------\n\n";
-                Instance best = ea.run(ea_num_iterations, ea_instance_size, pool, (const char *)ea_output_path);
-
-                for (int i = 2; i <= ea_num_runs; ++i) {
-                    // Forbid already used variables:
-                    // std::vector<int> vars = best.getVariables();
-                    // std::sort(vars.begin(), vars.end());
-                    // std::vector<int> difference;
-                    // std::set_difference(pool.begin(), pool.end(),
-                    //                     vars.begin(), vars.end(),
-                    //                     std::back_inserter(difference));
-                    // pool = difference;
-
-                    // Another run of EA
-                    std::cout << "\n=== [" << i << "/" << ea_num_runs << "]"
-                              << " -------------------------------------\n\n";
-                    best = ea.run(ea_num_iterations, ea_instance_size, pool, (const char *)ea_output_path);
+                if (ea_score_bias > 0) {
+                    auto scoreStart = std::chrono::high_resolution_clock::now();
+                    int threads = ea_score_threads > 0 ? (int)ea_score_threads : (int)std::thread::hardware_concurrency();
+                    scores = propagationScores(E, pool, threads);
+                    ea.varScores = scores;
+                    auto scoreTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::high_resolution_clock::now() - scoreStart).count();
+                    if (S.verbosity > 0) {
+                        std::cout << "Propagation scores: " << pool.size() << " variables in " << scoreTime / 1000.0 << " s" << std::endl;
+                    }
+                }
+
+                // Checkpoint of the job, identified by the formula, the pool and the search options:
+                std::unique_ptr<Checkpoint> ckpt;
+                int first_run = 1;
+                if (ea_checkpoint != NULL) {
+                    uint64_t bias_bits = doubleBits(ea_score_bias);
+                    std::vector<uint64_t> job{FitnessStore::formulaHash(E), (uint64_t)ea_num_runs, (uint64_t)ea_num_iterations,
+                                              (uint64_t)ea_instance_size, (uint64_t)ea_seed, ea_threads > 1, (uint64_t)ea_mu,
+                                              (uint64_t)ea_lambda, ea_comma, (uint64_t)ea_samples, bias_bits};
+                    job.insert(job.end(), pool.begin(), pool.end());
+                    // Sampling and per-run budgets change the trajectory of a run too:
+                    job.insert(job.end(), {(uint64_t)ea_sample_min_vars, doubleBits(ea_sample_confidence), ea_sample_recheck,
+                                           doubleBits(ea_time_limit), (uint64_t)ea_eval_limit, (uint64_t)ea_prop_limit,
+                                           (uint64_t)ea_stagnation});
+                    if (strategy == "tabu") job.insert(job.end(), {1, (uint64_t)ea_tabu_tenure, (uint64_t)ea_neighbours});
+                    if (strategy == "sa") job.insert(job.end(), {2, doubleBits(ea_sa_start), doubleBits(ea_sa_end)});
+                    if (ea_omega > 0) job.insert(job.end(), {doubleBits(ea_omega), (uint64_t)ea_max_size, doubleBits(ea_resize_rate)});
+                    ckpt.reset(new Checkpoint((const char *)ea_checkpoint, Checkpoint::fingerprint(job), (const char *)ea_output_path));
+                    ckpt->interval = std::chrono::seconds(ea_checkpoint_interval);
+                    if (ea_resume) {
+                        std::string error;
+                        if (!ckpt->load(error)) {
+                            std::cerr << "Error resuming: " << error << std::endl;
+                            return 1;
+                        }
+                        if (!ckpt->restoreOutput()) {
+                            std::cerr << "Error resuming: " << (const char *)ea_output_path
+                                      << " is shorter than at the checkpoint" << std::endl;
+                            return 1;
+                        }
+                        first_run = ckpt->completed() + 1;
+                        std::cout << "Resuming from " << (const char *)ea_checkpoint << " after "
+                                  << ckpt->completed() << " completed runs" << std::endl;
+                    } else {
+                        ckpt->start();
+                    }
+                    ea.checkpoint = ckpt.get();
+#if !(defined(__MINGW32__) || defined(_MSC_VER))
+                    checkpoint = ckpt.get();
+                    signal(SIGINT, SIGINT_checkpoint);
+                    signal(SIGTERM, SIGINT_checkpoint);
+                    signal(SIGXCPU, SIGINT_checkpoint);
+#endif
+                }
+
+                // The best backdoor of all runs, for the conquer stage:
+                std::vector<int> best_backdoor;
+                Fitness best_backdoor_fitness{};
+                auto offer = [&](const std::vector<int> &vars, const Fitness &fitness) {
+                    if (best_backdoor.empty() || fitness < best_backdoor_fitness) {
+                        best_backdoor = vars;
+                        best_backdoor_fitness = fitness;
+                    }
+                };
+
+                // Distributed runs: both sides fingerprint the formula, the pool and the search options
+                std::vector<uint64_t> distributed_job;
+                if (distributed) {
+                    uint64_t bias_bits = doubleBits(ea_score_bias);
+                    distributed_job = {FitnessStore::formulaHash(E), (uint64_t)ea_num_iterations, (uint64_t)ea_instance_size,
+                                       (uint64_t)ea_partitions, (uint64_t)ea_mu, (uint64_t)ea_lambda, ea_comma,
+                                       (uint64_t)ea_samples, bias_bits, (uint64_t)(strategy == "ea" ? 0 : strategy == "tabu" ? 1 : 2)};
+                    distributed_job.insert(distributed_job.end(), pool.begin(), pool.end());
+                    if (strategy == "tabu") distributed_job.insert(distributed_job.end(), {(uint64_t)ea_tabu_tenure, (uint64_t)ea_neighbours});
+                    if (strategy == "sa") distributed_job.insert(distributed_job.end(), {doubleBits(ea_sa_start), doubleBits(ea_sa_end)});
+                    if (ea_omega > 0) distributed_job.insert(distributed_job.end(), {doubleBits(ea_omega), (uint64_t)ea_max_size, doubleBits(ea_resize_rate)});
+                    if ((int)(pool.size() / ea_partitions) < ea_instance_size) {
+                        std::cerr << "Error: the pool slices of -ea-partitions are smaller than the instance size" << std::endl;
+                        return 1;
+                    }
+                }
+
+                if (ea_coordinator != 0) {
+                    Coordinator coordinator(Checkpoint::fingerprint(distributed_job), ea_num_runs, ea_seed, ea_partitions, ea_top_k);
+                    coordinator.cache = cache;
+                    coordinator.log = &std::cout;
+                    coordinator.onResult = [&](const RemoteBackdoor &result) {
+                        runs_done++;
+                        offer(result.vars, result.fitness);
+                    };
+                    std::string error;
+                    if (!coordinator.listen(std::max<int>(ea_coordinator, 0), error)) {
+                        std::cerr << "Error listening: " << error << std::endl;
+                        return 1;
+                    }
+                    std::cout << "Coordinator listening on port " << coordinator.port() << " for " << ea_num_runs << " runs" << std::endl;
+                    coordinator.serve();
+
+                    std::ostringstream records;
+                    for (const RemoteBackdoor &b : coordinator.top()) {
+                        RunResult top;
+                        top.kind = RunResult::Kind::Top;
+                        top.run = b.run;
+                        top.fitness = b.fitness;
+                        top.vars = b.vars;
+                        formatResult(records, result_format, top);
+                    }
+                    results->write(records.str());
+                    std::cout << "\nDistributed: " << coordinator.workers << " workers, " << coordinator.reassigned
+                              << " runs handed out again, " << coordinator.duplicates << " duplicate backdoors, "
+                              << coordinator.entries << " cache entries received (" << coordinator.newEntries << " new)" << std::endl;
+                } else if (ea_worker != NULL) {
+                    Worker remote;
+                    std::string error;
+                    if (!remote.connect((const char *)ea_worker, Checkpoint::fingerprint(distributed_job), 30, error)) {
+                        std::cerr << "Error connecting to the coordinator: " << error << std::endl;
+                        return 1;
+                    }
+                    std::unique_ptr<ParallelTreeEvaluator> parallel = make_parallel(E);
+                    ea.parallel = parallel.get();
+
+                    // The exact values found by this worker are reported along with each run:
+                    std::mutex entries_mutex;
+                    std::vector<RemoteBackdoor> entries;
+                    cache->onPersist = [&](const BackdoorRef &key, const Fitness &fitness) {
+                        RemoteBackdoor entry;
+                        entry.fitness = fitness;
+                        std::copy_if(key.data, key.data + key.size, std::back_inserter(entry.vars), [](int v) { return v != -1; });
+                        std::lock_guard<std::mutex> lock(entries_mutex);
+                        entries.push_back(std::move(entry));
+                    };
+
+                    RunAssignment assignment;
+                    while (remote.next(assignment, cache.get())) {
+                        std::cout << "\n=== [run " << assignment.run << "]"
+                                  << " -------------------------------------\n\n";
+                        ea.runNumber = assignment.run;
+                        std::ostringstream record;
+                        Instance found = ea.run(ea_num_iterations, ea_instance_size,
+                                                poolPartition(pool, assignment.partition, assignment.partitions), record, assignment.seed);
+                        results->write(record.str());
+                        runs_done++;
+                        RemoteBackdoor result;
+                        result.run = assignment.run;
+                        result.fitness = ea.lastFitness;
+                        result.vars = found.getVariables();
+                        offer(result.vars, result.fitness);
+                        std::vector<RemoteBackdoor> batch;
+                        {
+                            std::lock_guard<std::mutex> lock(entries_mutex);
+                            batch.swap(entries);
+                        }
+                        if (!remote.report(result, batch) || isJobLimit(ea.stopReason)) break;
+                    }
+                    cache->onPersist = nullptr;
+                } else if (ea_threads == 1) {
+                    std::unique_ptr<ParallelTreeEvaluator> parallel = make_parallel(E);
+                    ea.parallel = parallel.get();
+
+                    for (int i = first_run; i <= ea_num_runs; ++i) {
+                        // Forbid already used variables:
+                        // std::vector<int> vars = best.getVariables();
+                        // std::sort(vars.begin(), vars.end());
+                        // std::vector<int> difference;
+                        // std::set_difference(pool.begin(), pool.end(),
+                        //                     vars.begin(), vars.end(),
+                        //                     std::back_inserter(difference));
+                        // pool = difference;
+
+                        // Run EA
+                        std::cout << "\n=== [" << i << "/" << ea_num_runs << "]"
+                                  << " -------------------------------------\n\n";
+                        ea.runNumber = i;
+                        Instance found = ea.run(ea_num_iterations, ea_instance_size, pool, *results);
+                        if (ea.interrupted) break;
+                        runs_done++;
+                        offer(found.getVariables(), ea.lastFitness);
+                        if (ckpt) {
+                            // The next run continues the generator of this one:
+                            RunState next = ea.pendingState(i + 1);
+                            ckpt->complete(i, &next);
+                        }
+                        if (isJobLimit(ea.stopReason)) break;
+                    }
+                } else {
+                    // Parallel runs: each worker owns a copy of the simplified solver and its own EA.
+                    // Logs and results are buffered per run and flushed in run order.
+                    // With a checkpoint, finished runs are saved until they are flushed.
+                    int num_runs = ea_num_runs;
+                    std::vector<std::string> logs(num_runs);
+                    std::vector<std::string> records(num_runs);
+                    std::vector<char> done(num_runs, false);
+                    std::atomic<int> next_run(first_run - 1);
+                    int stopped_workers = 0;
+                    std::mutex mutex;
+                    std::condition_variable cv;
+
+                    auto worker = [&]() {
+                        Solver copy;
+                        E.copyTo(copy);
+                        EvolutionaryAlgorithm worker_ea(copy, -1, ea_shared_cache ? cache : make_cache());
+                        std::unique_ptr<ParallelTreeEvaluator> parallel = make_parallel(copy);
+                        worker_ea.parallel = parallel.get();
+                        configure(worker_ea);
+                        worker_ea.checkpoint = ckpt.get();
+                        for (int r = next_run++; r < num_runs && !(ckpt && ckpt->interrupted()) && job_usage->check(job_budget) == StopReason::None;
+                             r = next_run++) {
+                            std::ostringstream log, record;
+                            worker_ea.out = &log;
+                            log << "\n=== [" << (r + 1) << "/" << num_runs << "]"
+                                << " -------------------------------------\n\n";
+                            RunState saved;
+                            std::optional<Instance> found;
+                            if (ckpt && ckpt->get(r + 1, saved) && saved.finished) {
+                                log << "Restored from checkpoint" << std::endl;
+                                record << saved.record;
+                            } else {
+                                worker_ea.runNumber = r + 1;
+                                found.emplace(worker_ea.run(ea_num_iterations, ea_instance_size, pool, record,
+                                                            EvolutionaryAlgorithm::runSeed(ea_seed, r + 1)));
+                                if (worker_ea.interrupted) break;
+                                if (ckpt) {
+                                    saved = worker_ea.pendingState(r + 1);
+                                    saved.finished = true;
+                                    saved.record = record.str();
+                                    ckpt->update(saved);
+                                }
+                            }
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if (found) offer(found->getVariables(), worker_ea.lastFitness);
+                            logs[r] = log.str();
+                            records[r] = record.str();
+                            done[r] = true;
+                            cv.notify_all();
+                        }
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stopped_workers++;
+                        cv.notify_all();
+                    };
+
+                    int num_threads = std::max(1, std::min<int>(ea_threads, num_runs - first_run + 1));
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < num_threads; ++t) {
+                        threads.emplace_back(worker);
+                    }
+
+                    for (int r = first_run - 1; r < num_runs; ++r) {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        cv.wait(lock, [&] { return done[r] || stopped_workers == num_threads; });
+                        if (!done[r]) break;  // interrupted, or the job budget is spent
+                        std::cout << logs[r] << std::flush;
+                        results->write(records[r]);
+                        logs[r].clear();
+                        records[r].clear();
+                        runs_done++;
+                        if (ckpt) ckpt->complete(r + 1);
+                    }
+
+                    for (auto &thread : threads) {
+                        thread.join();
+                    }
+                }
+
+                if (ckpt && ckpt->interrupted()) {
+                    std::cout << "\n*** INTERRUPTED ***\n"
+                              << "Checkpoint saved to " << (const char *)ea_checkpoint << " after "
+                              << ckpt->completed() << " completed runs, continue with -ea-resume" << std::endl;
+                    return 1;
                 }
 
                 auto endTime = std::chrono::high_resolution_clock::now();
                 auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-                std::cout << "\nDone " << ea_num_runs << " EA runs"
+                std::cout << "\nDone " << runs_done << " EA runs"
                           << " in " << duration / 1000.0 << " s"
                           << std::endl;
+                StopReason job_stop = job_usage->check(job_budget);
+                if (job_stop != StopReason::None) {
+                    std::cout << "Stopped after " << runs_done << " runs: " << toString(job_stop) << std::endl;
+                }
+                if (ea_threads == 1 || ea_shared_cache) {
+                    std::cout << "Fitness cache: " << cache->size() << " entries"
+                              << " (" << cache->bytes() / (1024.0 * 1024.0) << " MB)"
+                              << ", hits: " << cache->hits()
+                              << ", misses: " << cache->misses()
+                              << ", evictions: " << cache->evictions()
+                              << std::endl;
+                }
+                if (store) {
+                    std::cout << "Fitness store: " << store->loaded() << " loaded, "
+                              << store->appended() << " appended" << std::endl;
+                }
 
                 if (S.verbosity > 0) {
                     fprintf(stderr, "\n");
                     printStats(S);
                 }
 
-            } else {
-                // ------------------------------------------------------
-
-                EvolutionaryAlgorithm ea(S, ea_seed);
-                S.ea = &ea;
+                if (ea_conquer) {
+                    if (best_backdoor.empty()) {
+                        std::cout << "\nNo backdoor to conquer" << std::endl;
+                        return 1;
+                    }
+                    // Solve 'S' by its hard cubes under the best backdoor:
+                    auto conquerStart = std::chrono::steady_clock::now();
+                    int threads = ea_conquer_threads > 0 ? (int)ea_conquer_threads : (int)std::thread::hardware_concurrency();
+                    Conquer conquer(S, std::max(threads, 1));
+                    conquer.shareSize = ea_conquer_share;
+                    double cube_seconds = 0, max_seconds = 0;
+                    conquer.report = [&](const CubeOutcome &c) {
+                        cube_seconds += c.seconds;
+                        max_seconds = std::max(max_seconds, c.seconds);
+                        if (S.verbosity == 0) return;
+                        std::cout << "Cube " << (c.index + 1) << " [";
+                        for (size_t i = 0; i < c.cube.size(); ++i) {
+                            std::cout << (i > 0 ? "," : "") << (c.cube[i] ? -(best_backdoor[i] + 1) : best_backdoor[i] + 1);
+                        }
+                        std::cout << "]: " << (c.status == l_True ? "SAT" : c.status == l_False ? "UNSAT" : "INDET")
+                                  << " in " << c.seconds << " s, " << c.conflicts << " conflicts" << std::endl;
+                    };
+                    std::cout << "\nConquer: " << best_backdoor.size() << " variables, fitness "
+                              << best_backdoor_fitness.fitness << ", " << conquer.nThreads() << " threads" << std::endl;
+                    lbool ret = conquer.solve(best_backdoor);
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - conquerStart).count();
+                    std::cout << "Conquered " << conquer.solved << " of " << conquer.cubes << " hard cubes in " << seconds << " s"
+                              << " (cube time " << cube_seconds << " s, longest " << max_seconds << " s)"
+                              << ", shared clauses: " << conquer.shared << std::endl;
+                    fprintf(stderr, ret == l_True ? "SATISFIABLE\n" : ret == l_False ? "UNSATISFIABLE\n" : "INDETERMINATE\n");
+                    if (res != NULL) writeResult(res, ret, conquer.model);
+                    return ret == l_True ? 10 : ret == l_False ? 20 : 0;
+                }
 
-                // ------------------------------------------------------
+            } else {
+                // CDCL on 'S', searching for backdoors in the background on snapshots of its clauses:
+                BackgroundSearch::Config bg;
+                bg.interval = ea_bg_interval;
+                bg.runs = ea_bg_runs;
+                bg.iterations = ea_num_iterations;
+                bg.instanceSize = ea_instance_size;
+                bg.threads = ea_threads;
+                bg.seed = ea_seed;
+                bg.phaseBudget = job_budget;
+                bg.cacheBytes = (size_t)ea_cache_mb * 1024 * 1024;
+                bg.dumpLearnts = ea_bg_dump_learnts;
+                bg.verbose = S.verbosity > 1;
+                bg.output = results;
+                bg.outputFormat = result_format;
+                bg.configure = configure;
+                std::unique_ptr<BackgroundSearch> background(new BackgroundSearch(bg));
+                S.background = background.get();
 
                 vec<Lit> dummy;
                 lbool ret = S.solveLimited(dummy);
+                S.background = nullptr;
+                background->stop();
                 if (S.verbosity > 0) {
+                    BackdoorResult best = background->best();
+                    fprintf(stderr, "Background search: %d phases, %d EA runs", background->phases(), background->runs());
+                    if (!best.vars.empty())
+                        fprintf(stderr, ", best fitness %g with %d variables", best.fitness.fitness, (int)best.vars.size());
+                    fprintf(stderr, "\n");
                     printStats(S);
                     fprintf(stderr, "\n");
                 }
                 fprintf(stderr, ret == l_True ? "SATISFIABLE\n" : ret == l_False ? "UNSATISFIABLE\n"
                                                                                  : "INDETERMINATE\n");
-                if (res != NULL) {
-                    if (ret == l_True) {
-                        fprintf(res, "SAT\n");
-                        for (int i = 0; i < S.nVars(); i++)
-                            if (S.model[i] != l_Undef)
-                                fprintf(res, "%s%s%d", (i == 0) ? "" : " ", (S.model[i] == l_True) ? "" : "-", i + 1);
-                        fprintf(res, " 0\n");
-                    } else if (ret == l_False)
-                        fprintf(res, "UNSAT\n");
-                    else
-                        fprintf(res, "INDET\n");
-                    fclose(res);
-                }
+                if (res != NULL) writeResult(res, ret, S.model);
 
 #ifdef NDEBUG
                 exit(ret == l_True ? 10 : ret == l_False ? 20
@@ -0,0 +1,87 @@
+#include "minisat/core/ParallelTree.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace Minisat {
+
+ParallelTreeEvaluator::ParallelTreeEvaluator(const Solver &solver, int numThreads, int splitDepth)
+    : pool(numThreads), splitDepth(splitDepth) {
+    for (int i = 0; i < numThreads; ++i) {
+        workers.emplace_back(new Solver);
+        solver.copyTo(*workers.back());
+    }
+}
+
+bool ParallelTreeEvaluator::gen_all_valid_assumptions_tree(
+    const std::vector<int> &variables,
+    uint64_t &total_count,
+    std::vector<std::vector<int>> &vector_of_assumptions,
+    int limit,
+    bool verb,
+    uint64_t cutoff) {
+    total_count = 0;
+    vector_of_assumptions.clear();
+
+    if (variables.empty()) {
+        return true;
+    }
+
+    // About 16 subtrees per worker, unless requested otherwise:
+    int depth = splitDepth;
+    if (depth <= 0) {
+        depth = 4;
+        while ((1 << depth) < 16 * nThreads()) depth++;
+    }
+    depth = std::min<int>(depth, variables.size());
+    int numTasks = 1 << depth;
+
+    std::vector<uint64_t> counts(numTasks, 0);
+    std::vector<std::vector<std::vector<int>>> cubes(numTasks);
+    std::atomic<uint64_t> found{0};  // hard tasks in the finished subtrees
+    std::atomic<bool> complete{true};
+
+    pool.parallelFor(numTasks, [&](int worker, int task) {
+        // Once over the cutoff, the remaining subtrees are skipped:
+        uint64_t seen = found.load();
+        if (seen > cutoff) {
+            complete = false;
+            return;
+        }
+        // Prefix signs are the binary digits of 'task', most significant first:
+        std::vector<int> prefix(depth);
+        for (int j = 0; j < depth; ++j) {
+            prefix[j] = (task >> (depth - 1 - j)) & 1;
+        }
+        if (!workers[worker]->gen_all_valid_assumptions_subtree(variables, prefix, counts[task], cubes[task], limit,
+                                                                false, cutoff - seen)) {
+            complete = false;
+        }
+        found += counts[task];
+    });
+
+    // Subtrees are in lexicographic order, so the first 'limit' cubes match the sequential walk:
+    for (int task = 0; task < numTasks; ++task) {
+        total_count += counts[task];
+        for (auto &cube : cubes[task]) {
+            if (vector_of_assumptions.size() >= static_cast<size_t>(limit)) break;
+            vector_of_assumptions.push_back(std::move(cube));
+        }
+    }
+
+    if (verb) {
+        std::cout << "c Parallel tree: " << numTasks << " subtrees on " << nThreads()
+                  << " threads, found valid: " << total_count << '\n';
+    }
+    return complete;
+}
+
+bool ParallelTreeEvaluator::count_valid_assumptions_tree(
+    const std::vector<int> &variables,
+    uint64_t &total_count,
+    uint64_t cutoff) {
+    std::vector<std::vector<int>> none;  // with 'limit' = 0 the workers only count
+    return gen_all_valid_assumptions_tree(variables, total_count, none, 0, false, cutoff);
+}
+
+}  // namespace Minisat
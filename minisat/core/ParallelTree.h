@@ -0,0 +1,54 @@
+#ifndef PARALLELTREE_H
+#define PARALLELTREE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "minisat/core/Solver.h"
+#include "minisat/utils/ThreadPool.h"
+
+namespace Minisat {
+
+// Parallel variant of 'Solver::gen_all_valid_assumptions_tree'.
+//
+// The first 'splitDepth' levels of the cube tree are enumerated up front; each resulting
+// prefix is a subtree task, which is walked by one of the workers. Every worker owns a copy of
+// the solver (its own trail and watches), so the subtrees are independent.
+class ParallelTreeEvaluator {
+   public:
+    // 'splitDepth' = 0 picks a depth giving enough subtrees to balance the load.
+    ParallelTreeEvaluator(const Solver &solver, int numThreads, int splitDepth = 0);
+
+    bool gen_all_valid_assumptions_tree(const std::vector<int> &variables,
+                                        uint64_t &total_count,
+                                        std::vector<std::vector<int>> &vector_of_assumptions,
+                                        int limit,
+                                        bool verb = false,
+                                        uint64_t cutoff = UINT64_MAX);
+
+    bool count_valid_assumptions_tree(const std::vector<int> &variables, uint64_t &total_count, uint64_t cutoff = UINT64_MAX);
+
+    [[nodiscard]] int nThreads() const {
+        return pool.size();
+    }
+
+    // Propagations of all workers; not to be called during an evaluation
+    [[nodiscard]] uint64_t propagations() const {
+        uint64_t total = 0;
+        for (const auto &worker : workers) total += worker->propagations;
+        return total;
+    }
+
+    int minVariables = 0;  // smaller backdoors are evaluated sequentially by the caller
+
+   private:
+    std::vector<std::unique_ptr<Solver>> workers;
+    ThreadPool pool;
+    int splitDepth;
+};
+
+}  // namespace Minisat
+
+#endif
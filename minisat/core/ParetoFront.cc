@@ -0,0 +1,46 @@
+#include "minisat/core/ParetoFront.h"
+
+#include "minisat/core/Instance.h"
+
+namespace Minisat {
+
+bool ParetoFront::add(const Instance &instance, const Fitness &fitness) {
+    if (!fitness.exact()) return false;
+    int size = instance.numVariables();
+    size_t pos = 0;
+    for (; pos < points.size() && points[pos].size <= size; ++pos) {
+        if (points[pos].fitness.rho >= fitness.rho) return false;
+    }
+    size_t end = pos;
+    while (end < points.size() && points[end].fitness.rho <= fitness.rho) ++end;
+    // Points of the same size have a lower 'rho', so they are among the dominated ones:
+    while (pos > 0 && points[pos - 1].size == size) --pos;
+    points.erase(points.begin() + pos, points.begin() + end);
+    points.insert(points.begin() + pos, Point{size, fitness, instance.getVariables()});
+    return true;
+}
+
+uint64_t ParetoFront::maxHard(const Instance &like, int size) const {
+    // The largest 'rho' at most 'size' variables, which a new point has to beat:
+    const Point *beat = nullptr;
+    for (const Point &p : points) {
+        if (p.size > size) break;
+        beat = &p;
+    }
+    if (beat == nullptr || size >= 64) return UINT64_MAX;
+    const double rho = beat->fitness.rho;
+    // 'rho' does not increase with the number of hard tasks; find the last 'h' with rho(h) > rho:
+    uint64_t lo = 0, hi = uint64_t(1) << size;
+    if (like.makeFitness(size, lo).rho <= rho) return 0;
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (like.makeFitness(size, mid).rho > rho) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+}  // namespace Minisat
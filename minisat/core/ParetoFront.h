@@ -0,0 +1,45 @@
+#ifndef PARETOFRONT_H
+#define PARETOFRONT_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "minisat/core/Fitness.h"
+
+namespace Minisat {
+
+struct Instance;
+
+// Backdoors not dominated in size and proportion of hard tasks: for every point, all smaller
+// backdoors seen have a larger proportion of hard tasks. Only exact fitness values are added.
+class ParetoFront {
+   public:
+    struct Point {
+        int size;
+        Fitness fitness;
+        std::vector<int> vars;  // sorted
+    };
+
+    // Adds 'instance' unless a backdoor of at most its size and at least its 'rho' is known, and
+    // drops the points it dominates; true if added
+    bool add(const Instance &instance, const Fitness &fitness);
+
+    // Most hard tasks a backdoor of 'size' variables, evaluated like 'like', may have to be added
+    // (UINT64_MAX if no point is that small)
+    [[nodiscard]] uint64_t maxHard(const Instance &like, int size) const;
+
+    void clear() { points.clear(); }
+    // Replaces the points, e.g. by those of a checkpoint
+    void assign(std::vector<Point> saved) { points = std::move(saved); }
+
+    // By increasing size and 'rho'
+    [[nodiscard]] const std::vector<Point> &get() const { return points; }
+
+   private:
+    std::vector<Point> points;
+};
+
+}  // namespace Minisat
+
+#endif
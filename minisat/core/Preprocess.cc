@@ -0,0 +1,169 @@
+#include "minisat/core/Preprocess.h"
+
+#include <algorithm>
+
+namespace Minisat {
+
+bool Preprocessor::run(Solver &out) {
+    const int n = solver.nVars();
+    out.verbosity = solver.verbosity;
+    for (Var v = 0; v < n; v++) out.newVar();
+    repr.resize(n);
+    for (Var v = 0; v < n; v++) repr[v] = mkLit(v);
+    edges.assign(2 * n, {});
+
+    if (!solver.okay() || !probe() || !solver.simplify() || !findEquivalences()) {
+        out.addEmptyClause();
+        return false;
+    }
+
+    // Top-level units, then the remaining clauses over the representatives:
+    for (Var v = 0; v < n; v++) {
+        if (solver.value(v) != l_Undef) out.addClause(mkLit(v, solver.value(v) == l_False));
+    }
+    vec<Lit> lits;
+    for (ClauseIterator it = solver.clausesBegin(); it != solver.clausesEnd(); ++it) {
+        const Clause &c = *it;
+        lits.clear();
+        bool satisfied = false;
+        for (int k = 0; k < c.size() && !satisfied; k++) {
+            if (solver.value(c[k]) == l_True) satisfied = true;
+            else if (solver.value(c[k]) == l_Undef) lits.push(repr[var(c[k])] ^ sign(c[k]));
+        }
+        if (!satisfied && !out.addClause_(lits)) return false;
+    }
+    return out.okay();
+}
+
+bool Preprocessor::probe() {
+    const int n = solver.nVars();
+    std::vector<char> seen(2 * n, 0);
+    vec<Lit> assumps, pos, neg;
+    std::vector<Lit> units;
+    assumps.push(lit_Undef);
+
+    for (Var v = 0; v < n; v++) {
+        if (solver.value(v) != l_Undef) continue;
+        probes++;
+        assumps[0] = mkLit(v);
+        bool pos_ok = solver.prop_check(assumps, pos);
+        assumps[0] = ~mkLit(v);
+        bool neg_ok = solver.prop_check(assumps, neg);
+
+        if (!pos_ok || !neg_ok) {
+            if (!pos_ok && !neg_ok) return false;
+            failed++;
+            if (!solver.addClause(pos_ok ? mkLit(v) : ~mkLit(v))) return false;
+            continue;
+        }
+
+        for (int i = 0; i < pos.size(); i++) seen[toInt(pos[i])] = 1;
+        units.clear();
+        for (int i = 0; i < neg.size(); i++) {
+            Lit q = neg[i];
+            if (var(q) == v) continue;
+            if (seen[toInt(q)]) {
+                units.push_back(q);
+            } else if (seen[toInt(~q)]) {
+                addEquivalence(mkLit(v), ~q);  // v implies ~q and ~v implies q
+            }
+        }
+        for (int i = 0; i < pos.size(); i++) seen[toInt(pos[i])] = 0;
+
+        for (Lit q : units) {
+            if (solver.value(q) == l_True) continue;
+            implied++;
+            if (!solver.addClause(q)) return false;
+        }
+    }
+    return true;
+}
+
+void Preprocessor::addEquivalence(Lit a, Lit b) {
+    edges[toInt(a)].push_back(toInt(b));
+    edges[toInt(b)].push_back(toInt(a));
+    edges[toInt(~a)].push_back(toInt(~b));
+    edges[toInt(~b)].push_back(toInt(~a));
+}
+
+bool Preprocessor::findEquivalences() {
+    const int n = solver.nVars();
+    auto unassigned = [&](int p) { return solver.value(toLit(p)) == l_Undef; };
+
+    // Implication graph over the free literals: binary clauses and equivalences found by probing
+    std::vector<std::vector<int>> graph(2 * n);
+    for (int p = 0; p < 2 * n; p++) {
+        if (!unassigned(p)) continue;
+        for (int q : edges[p]) {
+            if (unassigned(q)) graph[p].push_back(q);
+        }
+    }
+    for (ClauseIterator it = solver.clausesBegin(); it != solver.clausesEnd(); ++it) {
+        const Clause &c = *it;
+        int lits[3], size = 0;
+        bool satisfied = false;
+        for (int k = 0; k < c.size() && size < 3 && !satisfied; k++) {
+            if (solver.value(c[k]) == l_True) satisfied = true;
+            else if (solver.value(c[k]) == l_Undef) lits[size++] = toInt(c[k]);
+        }
+        if (satisfied || size != 2) continue;
+        graph[lits[0] ^ 1].push_back(lits[1]);
+        graph[lits[1] ^ 1].push_back(lits[0]);
+    }
+
+    // Tarjan's algorithm, iteratively:
+    std::vector<int> index(2 * n, -1), low(2 * n, 0), component(2 * n, -1);
+    std::vector<int> stack, path;
+    std::vector<size_t> next(2 * n, 0);
+    std::vector<char> on_stack(2 * n, 0);
+    int counter = 0, components = 0;
+    std::vector<int> members;
+    for (int root = 0; root < 2 * n; root++) {
+        if (!unassigned(root) || index[root] != -1) continue;
+        path.push_back(root);
+        while (!path.empty()) {
+            int p = path.back();
+            if (index[p] == -1) {
+                index[p] = low[p] = counter++;
+                stack.push_back(p);
+                on_stack[p] = 1;
+            }
+            if (next[p] < graph[p].size()) {
+                int q = graph[p][next[p]++];
+                if (index[q] == -1) {
+                    path.push_back(q);
+                } else if (on_stack[q]) {
+                    low[p] = std::min(low[p], index[q]);
+                }
+                continue;
+            }
+            path.pop_back();
+            if (!path.empty()) low[path.back()] = std::min(low[path.back()], low[p]);
+            if (low[p] != index[p]) continue;
+
+            // 'p' is the root of a component: pick the literal of the smallest variable
+            members.clear();
+            int q;
+            do {
+                q = stack.back();
+                stack.pop_back();
+                on_stack[q] = 0;
+                component[q] = components;
+                members.push_back(q);
+            } while (q != p);
+            int rep = *std::min_element(members.begin(), members.end());
+            for (int m : members) {
+                if (component[m ^ 1] == components) return false;  // l and ~l are equivalent
+                repr[m >> 1] = toLit(rep ^ (m & 1));
+            }
+            components++;
+        }
+    }
+
+    for (Var v = 0; v < n; v++) {
+        if (var(repr[v]) != v) substituted++;
+    }
+    return true;
+}
+
+}  // namespace Minisat
@@ -0,0 +1,47 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include <vector>
+
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+// Preprocessing of the clause database for the EA.
+//
+// Failed-literal probing propagates both literals of every free variable: a literal whose
+// propagation conflicts is fixed to false, and a literal implied by both is fixed to true.
+// Probing also finds equivalences (x implies l and ~x implies ~l). Together with the binary
+// clauses they form an implication graph whose strongly connected components are classes of
+// equivalent literals. Every literal is then replaced by the representative of its class, the
+// one with the smallest variable, in a fresh solver over the same variables. The substituted
+// variables occur in no clause of that solver, so they drop out of the EA pool.
+class Preprocessor {
+   public:
+    explicit Preprocessor(Solver &solver) : solver(solver) {}
+
+    // Fixes the failed and implied literals in 'solver' and writes the substituted clauses into
+    // the empty solver 'out'. Returns false if the formula was found unsatisfiable.
+    bool run(Solver &out);
+
+    // Literal that 'v' was replaced by ('mkLit(v)' if it was kept)
+    [[nodiscard]] Lit representative(Var v) const { return repr[v]; }
+
+    int probes = 0;       // probed variables
+    int failed = 0;       // failed literals
+    int implied = 0;      // literals implied by both literals of a probed variable
+    int substituted = 0;  // variables replaced by an equivalent literal
+
+   private:
+    bool probe();
+    bool findEquivalences();
+    void addEquivalence(Lit a, Lit b);
+
+    Solver &solver;
+    std::vector<std::vector<int>> edges;  // probed equivalences, per literal ('toInt')
+    std::vector<Lit> repr;
+};
+
+}  // namespace Minisat
+
+#endif
@@ -0,0 +1,585 @@
+#include "minisat/core/PropEngine.h"
+
+#include <algorithm>
+
+#include "minisat/utils/PackedCube.h"
+
+namespace Minisat {
+
+PropEngine::PropEngine(const Solver &solver) : num_vars(solver.nVars()) {
+    vals.assign(2 * num_vars, 0);
+    lanes.assign(2 * num_vars, 0);
+    watches.resize(2 * num_vars);
+    bin_start.assign(2 * num_vars + 1, 0);
+    tern_start.assign(2 * num_vars + 1, 0);
+    if (!solver.okay()) {
+        ok = false;
+        return;
+    }
+
+    // Top-level assignments:
+    for (Var v = 0; v < num_vars; v++) {
+        lbool x = solver.value(v);
+        if (x != l_Undef) assign(toInt(mkLit(v, x == l_False)));
+    }
+
+    // Simplified clauses, by size:
+    std::vector<int> binaries, ternaries, lits;
+    std::vector<uint32_t> longs;
+    for (ClauseIterator it = solver.clausesBegin(); it != solver.clausesEnd(); ++it) {
+        const Clause &c = *it;
+        lits.clear();
+        bool satisfied = false;
+        for (int k = 0; k < c.size() && !satisfied; k++) {
+            int p = toInt(c[k]);
+            if (isTrue(p)) satisfied = true;
+            else if (!isFalse(p)) lits.push_back(p);
+        }
+        if (satisfied) continue;
+
+        if (lits.empty()) {
+            ok = false;
+            return;
+        } else if (lits.size() == 1) {
+            assign(lits[0]);
+        } else if (lits.size() == 2) {
+            binaries.insert(binaries.end(), lits.begin(), lits.end());
+        } else if (lits.size() == 3) {
+            ternaries.insert(ternaries.end(), lits.begin(), lits.end());
+        } else {
+            uint32_t cref = arena.size();
+            longs.push_back(cref);
+            arena.push_back(lits.size());
+            arena.insert(arena.end(), lits.begin(), lits.end());
+            watches[lits[0] ^ 1].push_back(Watcher{cref, lits[1]});
+            watches[lits[1] ^ 1].push_back(Watcher{cref, lits[0]});
+        }
+    }
+
+    // Implication lists, indexed by the literal whose truth falsifies a clause literal:
+    for (size_t i = 0; i < binaries.size(); i++) bin_start[(binaries[i] ^ 1) + 1]++;
+    for (size_t i = 0; i < ternaries.size(); i++) tern_start[(ternaries[i] ^ 1) + 1] += 2;
+    for (int p = 0; p < 2 * num_vars; p++) {
+        bin_start[p + 1] += bin_start[p];
+        tern_start[p + 1] += tern_start[p];
+    }
+    bin_other.resize(binaries.size());
+    tern_others.resize(ternaries.size() * 2);
+    std::vector<uint32_t> bin_fill(bin_start.begin(), bin_start.end() - 1);
+    std::vector<uint32_t> tern_fill(tern_start.begin(), tern_start.end() - 1);
+    for (size_t i = 0; i < binaries.size(); i += 2) {
+        int a = binaries[i], b = binaries[i + 1];
+        bin_other[bin_fill[a ^ 1]++] = b;
+        bin_other[bin_fill[b ^ 1]++] = a;
+    }
+    for (size_t i = 0; i < ternaries.size(); i += 3) {
+        int t[3] = {ternaries[i], ternaries[i + 1], ternaries[i + 2]};
+        for (int k = 0; k < 3; k++) {
+            uint32_t &at = tern_fill[t[k] ^ 1];
+            tern_others[at++] = t[(k + 1) % 3];
+            tern_others[at++] = t[(k + 2) % 3];
+        }
+    }
+
+    occ_start.assign(2 * num_vars + 1, 0);
+    for (uint32_t cref : longs) {
+        for (int k = 1; k <= arena[cref]; k++) occ_start[(arena[cref + k] ^ 1) + 1]++;
+    }
+    for (int p = 0; p < 2 * num_vars; p++) occ_start[p + 1] += occ_start[p];
+    occ.resize(occ_start.back());
+    std::vector<uint32_t> occ_fill(occ_start.begin(), occ_start.end() - 1);
+    for (uint32_t cref : longs) {
+        for (int k = 1; k <= arena[cref]; k++) occ[occ_fill[arena[cref + k] ^ 1]++] = cref;
+    }
+    lane_pending.assign(2 * num_vars, 0);
+    conflict_score.assign(num_vars, 0);
+    component_mark.assign(num_vars, 0);
+    member_mark.assign(num_vars, 0);
+
+    // Propagate the top-level assignments through all the clauses:
+    qhead = 0;
+    if (!propagate()) ok = false;
+}
+
+bool PropEngine::propagate() {
+    while (qhead < trail.size()) {
+        int p = trail[qhead++];
+        int false_lit = p ^ 1;
+        propagations++;
+
+        for (uint32_t i = bin_start[p], end = bin_start[p + 1]; i < end; i++) {
+            int q = bin_other[i];
+            if (vals[q] == 0) {
+                assign(q);
+            } else if (vals[q] < 0) {
+                qhead = trail.size();
+                return false;
+            }
+        }
+
+        for (uint32_t i = tern_start[p], end = tern_start[p + 1]; i < end; i += 2) {
+            int q = tern_others[i], r = tern_others[i + 1];
+            if (isTrue(q) || isTrue(r)) continue;
+            if (isFalse(q)) {
+                if (isFalse(r)) {
+                    qhead = trail.size();
+                    return false;
+                }
+                assign(r);
+            } else if (isFalse(r)) {
+                assign(q);
+            }
+        }
+
+        std::vector<Watcher> &ws = watches[p];
+        size_t i = 0, j = 0, n = ws.size();
+        while (i < n) {
+            Watcher w = ws[i++];
+            if (isTrue(w.blocker)) {
+                ws[j++] = w;
+                continue;
+            }
+
+            // Make sure the false literal is the second one:
+            int *c = &arena[w.cref + 1];
+            int size = arena[w.cref];
+            if (c[0] == false_lit) std::swap(c[0], c[1]);
+            int first = c[0];
+            Watcher kept{w.cref, first};
+            if (first != w.blocker && isTrue(first)) {
+                ws[j++] = kept;
+                continue;
+            }
+
+            // Look for a new watch:
+            bool moved = false;
+            for (int k = 2; k < size; k++) {
+                if (!isFalse(c[k])) {
+                    c[1] = c[k];
+                    c[k] = false_lit;
+                    watches[c[1] ^ 1].push_back(kept);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            // Unit or conflicting:
+            ws[j++] = kept;
+            if (isFalse(first)) {
+                while (i < n) ws[j++] = ws[i++];
+                ws.resize(j);
+                qhead = trail.size();
+                return false;
+            }
+            assign(first);
+        }
+        ws.resize(j);
+    }
+    return true;
+}
+
+// Counts the hard leaves below the current node at 'level', as 'Solver::count_subtree', and
+// optionally passes them to 'sink'.
+bool PropEngine::walk(
+    const std::vector<int> &vars,
+    int level,
+    uint64_t signs,
+    uint64_t &total_count,
+    uint64_t cutoff,
+    int mark_level,
+    std::vector<uint64_t> *marks,
+    const Solver::CubeSink *sink) {
+    if (marks && level == mark_level) {
+        marks->push_back(signs);
+    }
+    int remaining = static_cast<int>(vars.size()) - level;
+    if (remaining == 0) {
+        if (sink) (*sink)(signs_scratch);
+        return ++total_count <= cutoff;
+    }
+    if (remaining <= std::min(bitLevels, MaxBitLevels) && (marks == nullptr || level > mark_level)) {
+        return walkLanes(vars, level, vars.size(), total_count, cutoff, sink);
+    }
+    for (int s = 0; s < 2; s++) {
+        bool go_on = true;
+        if (decide(toInt(mkLit(vars[level], s)))) {
+            if (sink) signs_scratch[level] = s;
+            go_on = walk(vars, level + 1, signs << 1 | s, total_count, cutoff, mark_level, marks, sink);
+        }
+        cancelUntil(level);
+        if (!go_on) return false;
+    }
+    return true;
+}
+
+// Lanes whose index has bit 'b' set, i.e. the cubes where the variable 'b' levels above the bottom is negative:
+static const uint64_t lane_bits[PropEngine::MaxBitLevels] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+
+bool PropEngine::walkLanes(
+    const std::vector<int> &vars,
+    int level,
+    int end,
+    uint64_t &total_count,
+    uint64_t cutoff,
+    const Solver::CubeSink *sink) {
+    const int r = end - level;
+    lane_all = r == 6 ? ~uint64_t(0) : (uint64_t(1) << (1 << r)) - 1;
+    lane_conflicts = 0;
+
+    // Lane 'i' assigns the signs given by the binary digits of 'i', most significant first:
+    for (int j = 0; j < r; j++) {
+        uint64_t negative = lane_bits[r - 1 - j] & lane_all;
+        int p = toInt(mkLit(vars[level + j]));
+        implyLanes(p, ~negative & lane_all);
+        implyLanes(p ^ 1, negative);
+    }
+    propagateLanes();
+
+    for (int v : lane_touched) {
+        lanes[2 * v] = 0;
+        lanes[2 * v + 1] = 0;
+    }
+    lane_touched.clear();
+
+    uint64_t hard = lane_all & ~lane_conflicts;
+    if (sink) {
+        for (int i = 0; i < (1 << r); i++) {
+            if (!((hard >> i) & 1)) continue;
+            for (int j = 0; j < r; j++) signs_scratch[level + j] = (i >> (r - 1 - j)) & 1;
+            (*sink)(signs_scratch);
+        }
+    }
+    uint64_t count = 0;
+    for (uint64_t rest = hard; rest != 0; rest &= rest - 1) count++;
+    nodes += uint64_t(1) << r;
+    conflicts += (uint64_t(1) << r) - count;
+    total_count += count;
+    return total_count <= cutoff;
+}
+
+void PropEngine::propagateLanes() {
+    while (!lane_queue.empty() && lane_conflicts != lane_all) {
+        int p = lane_queue.back();
+        lane_queue.pop_back();
+        // Lanes in which ~p became false; a clause only needs a look in the lanes where one of
+        // its literals just became false, as later changes are seen through the other literals.
+        uint64_t t = lane_pending[p] & ~lane_conflicts;
+        lane_pending[p] = 0;
+        if (t == 0) continue;
+        propagations++;
+
+        for (uint32_t i = bin_start[p], end = bin_start[p + 1]; i < end; i++) {
+            implyLanes(bin_other[i], t);
+        }
+
+        for (uint32_t i = tern_start[p], end = tern_start[p + 1]; i < end; i += 2) {
+            int q = tern_others[i], r = tern_others[i + 1];
+            implyLanes(r, t & lanes[q ^ 1]);
+            implyLanes(q, t & lanes[r ^ 1]);
+        }
+
+        for (uint32_t i = occ_start[p], end = occ_start[p + 1]; i < end; i++) {
+            const int *c = &arena[occ[i] + 1];
+            int size = arena[occ[i]];
+            // Lanes with some true literal, with at least one and with at least two unassigned ones:
+            uint64_t sat = 0, one = 0, two = 0;
+            int k = 0;
+            for (; k < size; k++) {
+                uint64_t tk = lanes[c[k]];
+                uint64_t unassigned = ~(tk | lanes[c[k] ^ 1]);
+                sat |= tk;
+                two |= one & unassigned;
+                one |= unassigned;
+                if ((t & ~(sat | two)) == 0) break;  // satisfied or not unit in every lane
+            }
+            if (k < size) continue;
+            uint64_t open = t & ~sat;
+            lane_conflicts |= open & ~one;
+            uint64_t unit = open & one & ~two;
+            if (unit == 0) continue;
+            for (int k = 0; k < size; k++) {
+                implyLanes(c[k], unit & ~(lanes[c[k]] | lanes[c[k] ^ 1]));
+            }
+        }
+    }
+    for (int p : lane_queue) lane_pending[p] = 0;
+    lane_queue.clear();
+}
+
+bool PropEngine::walkOrdered(int begin, int end, uint64_t &total_count, uint64_t cutoff, std::vector<uint64_t> *shape) {
+    if (shape) (*shape)[begin]++;
+    int remaining = end - begin;
+    if (remaining == 0) {
+        return ++total_count <= cutoff;
+    }
+    if (remaining <= std::min(bitLevels, MaxBitLevels)) {
+        return walkLanes(order, begin, end, total_count, cutoff, nullptr);
+    }
+    if (components && remaining >= componentMinVars) {
+        assert(shape == nullptr);
+        // Searches that find a single part are followed by exponentially growing gaps
+        if (component_skip > 0) {
+            component_skip--;
+        } else {
+            int from = begin;
+            int parts = splitComponents(begin, end, from);
+            if (parts > 1) {
+                component_backoff = 0;
+                return walkComponents(from, parts, total_count, cutoff);
+            }
+            component_backoff = std::min(2 * component_backoff + 1, MaxComponentBackoff);
+            component_skip = component_backoff;
+        }
+    }
+    if (dynamicOrder) {
+        int pick = begin;
+        for (int j = begin; j < end; j++) {
+            if (vals[2 * order[j]] != 0) {
+                pick = j;
+                break;
+            }
+            if (conflict_score[order[j]] > conflict_score[order[pick]]) pick = j;
+        }
+        std::swap(order[begin], order[pick]);
+    }
+    Var v = order[begin];
+    int level = decisionLevel();
+    for (int s = 0; s < 2; s++) {
+        bool go_on = true;
+        int p = toInt(mkLit(v, s));
+        bool forced = vals[p] != 0;
+        if (decide(p)) {
+            go_on = walkOrdered(begin + 1, end, total_count, cutoff, shape);
+        } else if (!forced) {
+            conflict_score[v]++;
+        }
+        cancelUntil(level);
+        if (!go_on) return false;
+    }
+    return true;
+}
+
+int PropEngine::splitComponents(int begin, int end, int &from) {
+    const uint32_t n = end - begin;
+    if (component_stamp > UINT32_MAX - n || member_stamp == UINT32_MAX) {
+        std::fill(component_mark.begin(), component_mark.end(), 0);
+        std::fill(member_mark.begin(), member_mark.end(), 0);
+        component_stamp = member_stamp = 0;
+    }
+    const uint32_t first = component_stamp + 1;
+    const uint32_t member = ++member_stamp;
+    uint32_t open = 0;  // unassigned variables of the range not reached yet
+    for (int i = begin; i < end; i++) {
+        member_mark[order[i]] = member;
+        if (vals[2 * order[i]] == 0) open++;
+    }
+
+    auto reach = [&](int q) {
+        int w = q >> 1;
+        if (vals[q] != 0 || component_mark[w] == component_stamp) return;
+        component_mark[w] = component_stamp;
+        if (member_mark[w] == member) open--;
+        component_queue.push_back(w);
+    };
+    for (int i = begin; i < end && open > 0; i++) {
+        Var root = order[i];
+        if (vals[2 * root] != 0 || component_mark[root] >= first) continue;
+        // Everything connected to 'root' by clauses not satisfied yet; the search can stop once
+        // it has reached all the variables of the range
+        component_stamp++;
+        component_queue.clear();
+        reach(toInt(mkLit(root)));
+        for (size_t head = 0; head < component_queue.size() && open > 0; head++) {
+            int u = component_queue[head];
+            // Clauses containing 'u' or '~u' are listed under the other literal of 'u':
+            for (int p = 2 * u; p <= 2 * u + 1; p++) {
+                for (uint32_t k = bin_start[p], e = bin_start[p + 1]; k < e; k++) {
+                    int q = bin_other[k];
+                    if (!isTrue(q)) reach(q);
+                }
+                for (uint32_t k = tern_start[p], e = tern_start[p + 1]; k < e; k += 2) {
+                    int q = tern_others[k], r = tern_others[k + 1];
+                    if (isTrue(q) || isTrue(r)) continue;
+                    reach(q);
+                    reach(r);
+                }
+                for (uint32_t k = occ_start[p], e = occ_start[p + 1]; k < e; k++) {
+                    const int *c = &arena[occ[k] + 1];
+                    int size = arena[occ[k]];
+                    bool satisfied = false;
+                    for (int m = 0; m < size && !satisfied; m++) satisfied = isTrue(c[m]);
+                    if (satisfied) continue;
+                    for (int m = 0; m < size; m++) reach(c[m]);
+                }
+            }
+        }
+    }
+    component_queue.clear();
+    if (component_stamp <= first) return 1;
+
+    // Fixed variables first, then the parts in the order they were found (insertion sort: the
+    // ranges are short)
+    auto key = [&](int v) { return vals[2 * v] != 0 ? 0 : component_mark[v]; };
+    for (int i = begin + 1; i < end; i++) {
+        int v = order[i];
+        int j = i;
+        for (; j > begin && key(order[j - 1]) > key(v); j--) order[j] = order[j - 1];
+        order[j] = v;
+    }
+    from = begin;
+    while (vals[2 * order[from]] != 0) from++;
+    int parts = 0;
+    for (int i = from + 1; i <= end; i++) {
+        if (i == end || key(order[i]) != key(order[i - 1])) {
+            component_ends.push_back(i);
+            parts++;
+        }
+    }
+    splits++;
+    return parts;
+}
+
+bool PropEngine::walkComponents(int from, int parts, uint64_t &total_count, uint64_t cutoff) {
+    const size_t first = component_ends.size() - parts;
+    auto saturating_mul = [](uint64_t a, uint64_t b) { return b != 0 && a > UINT64_MAX / b ? UINT64_MAX : a * b; };
+
+    // Product of the hard leaves of the parts; a part without any makes the node conflicting
+    uint64_t product = 1;
+    bool complete = true;
+    int start = from;
+    for (size_t g = first; g < first + parts; g++) {
+        int end = component_ends[g];
+        uint64_t count = 0;
+        // More than 'budget' leaves in this part exceed the cutoff, unless a later part has none
+        uint64_t budget = cutoff == UINT64_MAX ? UINT64_MAX : (cutoff - total_count) / product;
+        if (!walkOrdered(start, end, count, budget, nullptr)) {
+            complete = false;
+            for (size_t h = g + 1; h < first + parts && count > 0; h++) {
+                uint64_t some = 0;
+                walkOrdered(component_ends[h - 1], component_ends[h], some, 0, nullptr);
+                if (some == 0) count = 0;
+            }
+            if (count == 0) complete = true;
+        }
+        product = saturating_mul(product, count);
+        start = end;
+        if (!complete || product == 0) break;
+    }
+    component_ends.resize(first);
+    total_count = product > UINT64_MAX - total_count ? UINT64_MAX : total_count + product;
+    return complete && total_count <= cutoff;
+}
+
+bool PropEngine::count_valid_assumptions_tree(const std::vector<int> &variables, uint64_t &total_count, uint64_t cutoff) {
+    total_count = 0;
+    if (!ok) return true;
+    order = variables;
+    bool complete = walkOrdered(0, order.size(), total_count, cutoff, nullptr);
+    cancelUntil(0);
+    return complete;
+}
+
+std::vector<uint64_t> PropEngine::tree_shape(const std::vector<int> &variables) {
+    std::vector<uint64_t> shape(variables.size() + 1, 0);
+    if (!ok) return shape;
+    int bits = bitLevels;
+    bool split = components;
+    bitLevels = 0;
+    components = false;
+    uint64_t total_count = 0;
+    order = variables;
+    walkOrdered(0, order.size(), total_count, UINT64_MAX, &shape);
+    cancelUntil(0);
+    bitLevels = bits;
+    components = split;
+    return shape;
+}
+
+bool PropEngine::gen_all_valid_assumptions_tree(
+    const std::vector<int> &variables,
+    uint64_t &total_count,
+    const Solver::CubeSink &sink,
+    uint64_t cutoff) {
+    total_count = 0;
+    if (!ok) return true;
+    signs_scratch.assign(variables.size(), 0);
+    bool complete = walk(variables, 0, 0, total_count, cutoff, -1, nullptr, sink ? &sink : nullptr);
+    cancelUntil(0);
+    return complete;
+}
+
+bool PropEngine::gen_all_valid_assumptions_incremental(
+    const std::vector<int> &shared,
+    const std::vector<int> &changed,
+    const std::vector<uint64_t> *alive,
+    std::vector<uint64_t> *record,
+    uint64_t &total_count,
+    uint64_t cutoff) {
+    assert(shared.size() < 64);
+    total_count = 0;
+    if (!ok) return true;
+
+    const int u = shared.size();
+    std::vector<int> &vars = walk_vars;
+    vars.assign(shared.begin(), shared.end());
+    vars.insert(vars.end(), changed.begin(), changed.end());
+
+    if (alive == nullptr) {
+        bool complete = walk(vars, 0, 0, total_count, cutoff, u, record, nullptr);
+        cancelUntil(0);
+        return complete;
+    }
+
+    // Visit the memoized prefixes in lexicographic order, keeping the common part on the trail:
+    bool complete = true;
+    uint64_t prev = 0;
+    for (uint64_t signs : *alive) {
+        int from = 0;
+        if (decisionLevel() > 0) {
+            uint64_t diff = signs ^ prev;
+            if (diff == 0) continue;
+            from = std::min(u - 1 - PackedCube::highestBit(diff), decisionLevel());
+        }
+        cancelUntil(from);
+        prev = signs;
+
+        int j = from;
+        for (; j < u; ++j) {
+            if (!decide(toInt(mkLit(shared[j], (signs >> (u - 1 - j)) & 1)))) {
+                cancelUntil(j);
+                break;
+            }
+        }
+        if (j == u && !walk(vars, u, signs, total_count, cutoff, -1, nullptr, nullptr)) {
+            complete = false;
+            break;
+        }
+    }
+
+    cancelUntil(0);
+    return complete;
+}
+
+uint64_t PropEngine::sample_valid_assumptions(const std::vector<int> &variables, uint64_t samples, std::mt19937 &gen) {
+    if (!ok) {
+        return 0;
+    }
+    uint64_t hard = 0;
+    for (uint64_t n = 0; n < samples; ++n) {
+        bool conflict = false;
+        uint32_t bits = 0;
+        for (size_t j = 0; j < variables.size() && !conflict; ++j) {
+            if (j % 32 == 0) bits = gen();
+            conflict = !decide(toInt(mkLit(variables[j], (bits >> (j % 32)) & 1)));
+        }
+        if (!conflict) hard++;
+        cancelUntil(0);
+    }
+    return hard;
+}
+
+}  // namespace Minisat
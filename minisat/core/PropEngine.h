@@ -0,0 +1,189 @@
+#ifndef PROPENGINE_H
+#define PROPENGINE_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+// Unit propagation engine for backdoor evaluation.
+//
+// Built once from the clause database of a solver at decision level 0: satisfied clauses are
+// dropped and false literals removed. Binary and ternary clauses live in static per-literal
+// implication lists, which never move during propagation; longer clauses are stored back to
+// back in one flat arena and use two watched literals with blockers. There are no learnt
+// clauses, activities or lazily cleaned watch lists. The tree walks visit the cube tree in the
+// same order as the 'Solver' ones and give the same counts.
+//
+// The last 'bitLevels' levels of a tree walk can be evaluated bit-parallel: the 2^bitLevels
+// cubes below a node are the lanes of a 64-bit word, each literal keeps the mask of lanes in
+// which it is true, and one propagation over the masks yields the mask of conflicting lanes.
+// Since unit propagation is confluent, a lane conflicts exactly when the sequential walk of its
+// cube does.
+//
+// For the same reason the counting walk may branch on the variables in any order. With
+// 'dynamicOrder' it picks, at every node, a variable already fixed by propagation if there is
+// one, and otherwise the one whose decisions conflicted most often so far, so that conflicts
+// show up higher in the tree. The cube streaming and incremental walks keep the given order.
+//
+// With 'components' the counting walk also looks, at nodes with at least 'componentMinVars'
+// backdoor variables left, for sets of them that no clause left open by the current cube
+// connects (through unassigned variables of any kind). Propagation in one set then never
+// reaches another, so the hard leaves below the node are the product of the counts of the sets,
+// which are walked one after the other instead of nested.
+class PropEngine {
+   public:
+    static constexpr int MaxBitLevels = 6;  // 64 lanes
+
+    explicit PropEngine(const Solver &solver);
+
+    [[nodiscard]] int nVars() const { return num_vars; }
+    [[nodiscard]] bool okay() const { return ok; }
+
+    // Same contracts as the 'Solver' functions of the same names:
+    bool count_valid_assumptions_tree(const std::vector<int> &d_set, uint64_t &total_count, uint64_t cutoff = UINT64_MAX);
+    bool gen_all_valid_assumptions_tree(const std::vector<int> &d_set, uint64_t &total_count, const Solver::CubeSink &sink, uint64_t cutoff = UINT64_MAX);
+    bool gen_all_valid_assumptions_incremental(const std::vector<int> &shared, const std::vector<int> &changed, const std::vector<uint64_t> *alive,
+                                               std::vector<uint64_t> *record, uint64_t &total_count, uint64_t cutoff = UINT64_MAX);
+    uint64_t sample_valid_assumptions(const std::vector<int> &d_set, uint64_t samples, std::mt19937 &gen);
+
+    // Number of non-conflicting nodes on each level of the counting walk (the sizes of the
+    // complete levels of the backdoor tree), evaluated without the bit-parallel levels
+    std::vector<uint64_t> tree_shape(const std::vector<int> &d_set);
+
+    uint64_t propagations = 0;  // number of propagated literals (or lane masks)
+    uint64_t nodes = 0;         // cube tree nodes decided (every lane of a bit-parallel evaluation counts)
+    uint64_t conflicts = 0;     // nodes whose decision conflicted
+    int bitLevels = 0;          // bottom levels of the tree walks evaluated bit-parallel, at most 'MaxBitLevels'
+    bool dynamicOrder = false;  // choose the branching variable per node in the counting walk
+    bool components = false;    // count independent parts of the residual formula separately in the counting walk
+    int componentMinVars = 8;   // backdoor variables left at a node for looking for independent parts
+    uint64_t splits = 0;        // counting walk nodes split into independent parts
+
+   private:
+    struct Watcher {
+        uint32_t cref;    // offset of the clause in 'arena'
+        int blocker;      // some other literal of the clause
+    };
+
+    // Literals are 'toInt(Lit)', so the negation of 'p' is 'p ^ 1'
+    [[nodiscard]] bool isTrue(int p) const { return vals[p] > 0; }
+    [[nodiscard]] bool isFalse(int p) const { return vals[p] < 0; }
+
+    int decisionLevel() const { return trail_lim.size(); }
+    void newDecisionLevel() { trail_lim.push_back(trail.size()); }
+    void assign(int p) {
+        vals[p] = 1;
+        vals[p ^ 1] = -1;
+        lanes[p] = ~uint64_t(0);
+        trail.push_back(p);
+    }
+    void cancelUntil(int level) {
+        if (decisionLevel() <= level) return;
+        for (size_t i = trail.size(); i-- > static_cast<size_t>(trail_lim[level]);) {
+            vals[trail[i]] = 0;
+            vals[trail[i] ^ 1] = 0;
+            lanes[trail[i]] = 0;
+        }
+        trail.resize(trail_lim[level]);
+        trail_lim.resize(level);
+        qhead = trail.size();
+    }
+
+    bool propagate();  // false on conflict
+
+    // Decides 'p' at a new decision level; false if it is false or propagating it conflicts
+    bool decide(int p) {
+        nodes++;
+        if (isFalse(p)) return conflicts++, false;
+        newDecisionLevel();
+        if (isTrue(p)) return true;
+        assign(p);
+        if (propagate()) return true;
+        conflicts++;
+        return false;
+    }
+
+    bool walk(const std::vector<int> &vars, int level, uint64_t signs, uint64_t &total_count, uint64_t cutoff,
+              int mark_level, std::vector<uint64_t> *marks, const Solver::CubeSink *sink);
+
+    // Counting walk over 'order[begin..end)', which it permutes when 'dynamicOrder' or
+    // 'components' is set. 'shape' is indexed by 'begin', so it needs 'components' off.
+    bool walkOrdered(int begin, int end, uint64_t &total_count, uint64_t cutoff, std::vector<uint64_t> *shape);
+
+    // Groups the unassigned variables of 'order[begin..end)' by the parts of the residual formula.
+    // If there are several, moves the variables fixed by propagation (each a factor of 1) to the
+    // front, sets 'from' past them, appends the end of every group to 'component_ends' and returns
+    // the number of groups; otherwise returns 1 and leaves everything alone.
+    int splitComponents(int begin, int end, int &from);
+    // Counting walk over the last 'parts' groups of 'component_ends', starting at 'from'
+    bool walkComponents(int from, int parts, uint64_t &total_count, uint64_t cutoff);
+
+    // Bit-parallel evaluation of all the cubes over 'vars[level..end)' below the current node:
+    bool walkLanes(const std::vector<int> &vars, int level, int end, uint64_t &total_count, uint64_t cutoff, const Solver::CubeSink *sink);
+
+    // Makes 'p' true in the lanes 'mask' (conflicting lanes are left alone)
+    void implyLanes(int p, uint64_t mask) {
+        mask &= ~(lane_conflicts | lanes[p]);
+        if (mask == 0) return;
+        if (vals[p] < 0) {
+            lane_conflicts |= mask;
+            return;
+        }
+        if (lanes[p] == 0 && lanes[p ^ 1] == 0) lane_touched.push_back(p >> 1);
+        lanes[p] |= mask;
+        lane_conflicts |= lanes[p] & lanes[p ^ 1];
+        if (lane_pending[p] == 0) lane_queue.push_back(p);
+        lane_pending[p] |= mask;
+    }
+    void propagateLanes();
+
+    int num_vars = 0;
+    bool ok = true;
+    std::vector<int8_t> vals;  // per literal: 1 true, -1 false, 0 unassigned
+    std::vector<int> trail;
+    std::vector<int> trail_lim;
+    size_t qhead = 0;
+
+    // Clauses made unit or falsified by 'p' becoming true, for the literals in [start[p], start[p+1]):
+    std::vector<uint32_t> bin_start;
+    std::vector<int> bin_other;           // (~p, q): 'q' must be true
+    std::vector<uint32_t> tern_start;
+    std::vector<int> tern_others;         // (~p, q, r): pairs 'q', 'r'
+
+    std::vector<int> arena;               // long clauses: size, then literals
+    std::vector<std::vector<Watcher>> watches;
+    std::vector<uint32_t> occ_start;      // long clauses containing ~p, for the bit-parallel propagation
+    std::vector<uint32_t> occ;
+
+    // Bit-parallel state:
+    std::vector<uint64_t> lanes;          // per literal: lanes in which it is true (all of them if assigned true)
+    std::vector<uint64_t> lane_pending;   // per literal: lanes in which it became true but is not propagated yet
+    std::vector<int> lane_queue;
+    std::vector<int> lane_touched;        // variables with non-zero masks
+    uint64_t lane_conflicts = 0;
+    uint64_t lane_all = 0;                // the lanes in use
+
+    std::vector<int> signs_scratch;       // cube passed to the sink
+    std::vector<int> order;               // variables of the counting walk
+    std::vector<int> walk_vars;           // variables of the incremental walk
+    std::vector<uint32_t> conflict_score; // per variable: decisions on it that conflicted
+
+    // Component search:
+    std::vector<uint32_t> component_mark; // per variable: last search that reached it
+    std::vector<uint32_t> member_mark;    // per variable: last split whose range contains it
+    uint32_t component_stamp = 0;
+    uint32_t member_stamp = 0;
+    static constexpr uint32_t MaxComponentBackoff = 1023;
+    uint32_t component_backoff = 0;       // nodes skipped after the last search that found a single part,
+    uint32_t component_skip = 0;          // and still to skip
+    std::vector<int> component_queue;
+    std::vector<int> component_ends;      // group ends of the splits in progress, innermost last
+};
+
+}  // namespace Minisat
+
+#endif
@@ -0,0 +1,164 @@
+#include "minisat/core/ResultWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace Minisat {
+
+namespace {
+
+void putVars(std::ostream &os, const std::vector<int> &vars) {
+    os << "[";
+    for (size_t i = 0; i < vars.size(); ++i) os << (i > 0 ? ", " : "") << vars[i];
+    os << "]";
+}
+
+// Cube 'k' of 'result' as DIMACS literals
+void putCube(std::ostream &os, const RunResult &result, size_t k, const char *separator) {
+    const size_t n = result.vars.size();
+    for (size_t i = 0; i < n; ++i) {
+        int lit = result.vars[i] + 1;
+        os << (i > 0 ? separator : "") << (result.cubes[k * n + i] ? -lit : lit);
+    }
+}
+
+// JSON has no infinities; they are written as null
+void putDouble(std::ostream &os, double x) {
+    if (std::isfinite(x)) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.17g", x);
+        os << buf;
+    } else {
+        os << "null";
+    }
+}
+
+void formatText(std::ostream &os, const RunResult &r) {
+    const Fitness &f = r.fitness;
+    switch (r.kind) {
+        case RunResult::Kind::Phase:
+            os << "---" << std::endl;
+            return;
+        case RunResult::Kind::Front:
+            os << "Front fitness " << f.fitness << " (rho=" << f.rho << ", hard=" << f.hard << ") with " << r.vars.size()
+               << " variables: ";
+            break;
+        case RunResult::Kind::Top:
+            os << "Best fitness " << f.fitness << " (rho=" << f.rho << ", hard=" << f.hard << ") on run " << r.run << " with "
+               << r.vars.size() << " variables: ";
+            break;
+        case RunResult::Kind::Best:
+            os << "Best fitness " << f.fitness << " (rho=" << f.rho << ", hard=" << f.hard << ") on iteration " << r.iteration
+               << " with " << r.vars.size() << " variables: ";
+            break;
+    }
+    putVars(os, r.vars);
+    os << std::endl;
+    size_t numCubes = r.vars.empty() ? 0 : r.cubes.size() / r.vars.size();
+    for (size_t k = 0; k < numCubes; ++k) {
+        os << "Cube [";
+        putCube(os, r, k, ", ");
+        os << "]\n";
+    }
+}
+
+void formatJson(std::ostream &os, const RunResult &r) {
+    static const char *types[] = {"best", "front", "top", "phase"};
+    os << "{\"type\":\"" << types[static_cast<int>(r.kind)] << "\"";
+    if (r.kind == RunResult::Kind::Phase) {
+        os << ",\"phase\":" << r.run << "}\n";
+        return;
+    }
+    const Fitness &f = r.fitness;
+    os << ",\"run\":" << r.run;
+    if (r.kind == RunResult::Kind::Best) {
+        os << ",\"iteration\":" << r.iteration << ",\"seconds\":";
+        putDouble(os, r.seconds);
+        os << ",\"reason\":\"" << toString(r.reason) << "\"";
+    }
+    os << ",\"fitness\":";
+    putDouble(os, f.fitness);
+    os << ",\"rho\":";
+    putDouble(os, f.rho);
+    os << ",\"hard\":" << f.hard << ",\"lower_bound\":" << (f.lowerBound ? "true" : "false") << ",\"error\":";
+    putDouble(os, f.error);
+    os << ",\"vars\":[";
+    for (size_t i = 0; i < r.vars.size(); ++i) os << (i > 0 ? "," : "") << r.vars[i];
+    os << "]";
+    if (!r.cubes.empty()) {
+        os << ",\"cubes\":[";
+        size_t numCubes = r.cubes.size() / r.vars.size();
+        for (size_t k = 0; k < numCubes; ++k) {
+            os << (k > 0 ? ",[" : "[");
+            putCube(os, r, k, ",");
+            os << "]";
+        }
+        os << "]";
+    }
+    os << "}\n";
+}
+
+void formatBinary(std::ostream &os, const RunResult &r) {
+    const size_t n = r.vars.size();
+    BinaryRecord header{};
+    header.magic = BinaryRecord::Magic;
+    header.kind = static_cast<uint32_t>(r.kind);
+    header.flags = r.fitness.lowerBound ? 1 : 0;
+    header.reason = static_cast<uint32_t>(r.reason);
+    header.run = r.run;
+    header.iteration = r.iteration;
+    header.count = static_cast<uint32_t>(n);
+    header.hard = r.fitness.hard;
+    header.cubes = n == 0 ? 0 : r.cubes.size() / n;
+    header.fitness = r.fitness.fitness;
+    header.rho = r.fitness.rho;
+    header.error = r.fitness.error;
+    header.seconds = r.seconds;
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<int32_t> vars(r.vars.begin(), r.vars.end());
+    os.write(reinterpret_cast<const char *>(vars.data()), vars.size() * sizeof(int32_t));
+    std::vector<char> bits((n + 7) / 8);
+    for (uint64_t k = 0; k < header.cubes; ++k) {
+        std::fill(bits.begin(), bits.end(), 0);
+        for (size_t i = 0; i < n; ++i) {
+            if (r.cubes[k * n + i]) bits[i / 8] |= static_cast<char>(1 << (i % 8));
+        }
+        os.write(bits.data(), bits.size());
+    }
+}
+
+}  // namespace
+
+void formatResult(std::ostream &os, ResultFormat format, const RunResult &result) {
+    switch (format) {
+        case ResultFormat::Text: formatText(os, result); break;
+        case ResultFormat::Jsonl: formatJson(os, result); break;
+        case ResultFormat::Binary: formatBinary(os, result); break;
+    }
+}
+
+ResultWriter::ResultWriter(const std::string &path, size_t bufferBytes) : buffer(bufferBytes) {
+    file = fopen(path.c_str(), "ab");
+    if (file && !buffer.empty()) setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+}
+
+ResultWriter::~ResultWriter() {
+    if (file) fclose(file);
+}
+
+void ResultWriter::write(const std::string &records) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file || records.empty()) return;
+    fwrite(records.data(), 1, records.size(), file);
+    fflush(file);
+}
+
+void ResultWriter::write(ResultFormat format, const RunResult &result) {
+    std::ostringstream record;
+    formatResult(record, format, result);
+    write(record.str());
+}
+
+}  // namespace Minisat
@@ -0,0 +1,92 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "minisat/core/Budget.h"
+#include "minisat/core/Fitness.h"
+
+namespace Minisat {
+
+// A backdoor reported by an EA job
+struct RunResult {
+    enum class Kind {
+        Best,   // the best backdoor of a run
+        Front,  // a point of the size/hardness front of a run
+        Top,    // one of the best distinct backdoors collected by a coordinator
+        Phase,  // start of a background search phase 'run' (no backdoor)
+    };
+
+    Kind kind = Kind::Best;
+    int run = 0;
+    int iteration = 0;  // on which the backdoor was found (Best only)
+    double seconds = 0;  // of the run (Best only)
+    StopReason reason = StopReason::None;
+    Fitness fitness{};
+    std::vector<int> vars;  // sorted, 0-based
+    // The hard cubes, if exported: 'vars.size()' signs (1 = negative) per cube
+    std::vector<uint8_t> cubes;
+};
+
+// Format of the backdoor output file.
+//
+// Text writes the human-readable "Best fitness ..." lines, with one "Cube [...]" line of
+// DIMACS literals per hard cube. Jsonl writes one object per result with "type" "best", "front",
+// "top" or "phase". Binary writes 'BinaryRecord' headers in native byte order, each followed by
+// the int32 variables and the cubes as bit sets of '(count + 7) / 8' bytes (bit i set: variable i
+// negative).
+enum class ResultFormat { Text, Jsonl, Binary };
+
+struct BinaryRecord {
+    static constexpr uint32_t Magic = 0x52424145;  // "EABR"
+
+    uint32_t magic;
+    uint32_t kind;       // 'RunResult::Kind'
+    uint32_t flags;      // bit 0: the fitness is a lower bound
+    uint32_t reason;     // 'StopReason'
+    int32_t run;
+    int32_t iteration;
+    uint32_t count;      // variables
+    uint32_t reserved;
+    uint64_t hard;
+    uint64_t cubes;      // hard cubes following the variables
+    double fitness;
+    double rho;
+    double error;
+    double seconds;
+};
+
+// Appends 'result' to 'os' in the given format
+void formatResult(std::ostream &os, ResultFormat format, const RunResult &result);
+
+// The backdoor output file of a job, kept open with a large buffer and shared by all its runs and
+// threads. Records are formatted by the runs (see 'formatResult') and written whole.
+class ResultWriter {
+   public:
+    explicit ResultWriter(const std::string &path, size_t bufferBytes = 1 << 20);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    [[nodiscard]] bool isOpen() const { return file != nullptr; }
+
+    // Writes one or more formatted records, then flushes them
+    void write(const std::string &records);
+
+    void write(ResultFormat format, const RunResult &result);
+
+   private:
+    std::mutex mutex;
+    FILE *file = nullptr;
+    std::vector<char> buffer;
+};
+
+}  // namespace Minisat
+
+#endif
@@ -28,8 +28,10 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <string>
 #include <vector>
 
+#include "minisat/core/BackgroundSearch.h"
 #include "minisat/core/EA.h"
 #include "minisat/mtl/Sort.h"
+#include "minisat/utils/PackedCube.h"
 
 using namespace Minisat;
 
@@ -48,6 +50,7 @@ static BoolOption opt_rnd_init_act(_cat, "rnd-init", "Randomize the initial acti
 static BoolOption opt_luby_restart(_cat, "luby", "Use the Luby restart sequence", true);
 static IntOption opt_restart_first(_cat, "rfirst", "The base restart interval", 100, IntRange(1, INT32_MAX));
 static DoubleOption opt_restart_inc(_cat, "rinc", "Restart interval increase factor", 2, DoubleRange(1, false, HUGE_VAL, false));
+static BoolOption opt_bump_backdoors(_cat, "bump-backdoors", "Prioritise the variables of backdoors found in the background", true);
 static DoubleOption opt_garbage_frac(_cat, "gc-frac", "The fraction of wasted memory allowed before a garbage collection is triggered", 0.20, DoubleRange(0, false, HUGE_VAL, false));
 
 //=================================================================================================
@@ -55,6 +58,10 @@ static DoubleOption opt_garbage_frac(_cat, "gc-frac", "The fraction of wasted me
 
 Solver::Solver() :
 
+                   background(nullptr),
+                   bump_backdoors(opt_bump_backdoors),
+                   learnt_export_size(0),
+
                    // Parameters (user settable):
                    //
                    verbosity(0),
@@ -96,7 +103,8 @@ Solver::Solver() :
                    clauses_literals(0),
                    learnts_literals(0),
                    max_literals(0),
-                   tot_literals(0)
+                   tot_literals(0),
+                   tree_nodes(0)
 
                    ,
                    ok(true),
@@ -109,6 +117,7 @@ Solver::Solver() :
                    order_heap(VarOrderLt(activity)),
                    progress_estimate(0),
                    remove_satisfied(true),
+                   lbd_stamp(0),
 
                    // Resource constraints:
                    //
@@ -183,6 +192,70 @@ bool Solver::addClause_(vec<Lit>& ps) {
     return true;
 }
 
+// Copies the current top-level state into the fresh solver 'copy': all variables (with their
+// polarity and decision mode), the top-level units and the problem clauses. Learnt clauses are not
+// copied. Used to give each worker thread its own (already simplified) clause database.
+//
+void Solver::copyTo(Solver& copy) const {
+    assert(decisionLevel() == 0);
+    assert(copy.nVars() == 0);
+    copy.verbosity = verbosity;
+
+    for (Var v = 0; v < nVars(); v++)
+        copy.newVar(polarity[v], decision[v]);
+
+    if (!ok) {
+        copy.addEmptyClause();
+        return;
+    }
+
+    for (int i = 0; i < trail.size(); i++)
+        copy.addClause(trail[i]);
+
+    vec<Lit> lits;
+    for (int i = 0; i < clauses.size(); i++) {
+        const Clause& c = ca[clauses[i]];
+        lits.clear();
+        for (int k = 0; k < c.size(); k++)
+            lits.push(c[k]);
+        copy.addClause_(lits);
+    }
+}
+
+void Solver::forEachLearnt(const std::function<void(const Clause&)>& f) const {
+    for (int i = 0; i < learnts.size(); i++)
+        f(ca[learnts[i]]);
+}
+
+int Solver::computeLBD(const vec<Lit>& c) {
+    lbd_seen.growTo(decisionLevel() + 1, 0);
+    lbd_stamp++;
+    int n = 0;
+    for (int i = 0; i < c.size(); i++) {
+        int l = level(var(c[i]));
+        if (lbd_seen[l] != lbd_stamp) lbd_seen[l] = lbd_stamp, n++;
+    }
+    return n;
+}
+
+int Solver::exportClauses(std::vector<int>& lits, bool learnt) const {
+    assert(decisionLevel() == 0);
+    auto put = [&](Lit p) { lits.push_back(sign(p) ? -(var(p) + 1) : var(p) + 1); };
+    int n = 0;
+    if (!learnt) {
+        for (int i = 0; i < trail.size(); i++, n++)
+            put(trail[i]), lits.push_back(0);
+    }
+    const vec<CRef>& cs = learnt ? learnts : clauses;
+    for (int i = 0; i < cs.size(); i++, n++) {
+        const Clause& c = ca[cs[i]];
+        for (int k = 0; k < c.size(); k++)
+            put(c[k]);
+        lits.push_back(0);
+    }
+    return n;
+}
+
 void Solver::attachClause(CRef cr) {
     const Clause& c = ca[cr];
     assert(c.size() > 1);
@@ -660,6 +733,8 @@ lbool Solver::search(int nof_conflicts) {
 
             learnt_clause.clear();
             analyze(confl, learnt_clause, backtrack_level);
+            if (learnt_export && learnt_clause.size() <= learnt_export_size)
+                learnt_export(learnt_clause, computeLBD(learnt_clause));
             cancelUntil(backtrack_level);
 
             if (learnt_clause.size() == 1) {
@@ -798,59 +873,23 @@ lbool Solver::solve_() {
         fprintf(stderr, "===============================================================================\n");
     }
 
-    auto startTime = std::chrono::steady_clock::now();
-    bool first = true;
-    int runNumber = 0;
-
     // Search:
     int curr_restarts = 0;
     while (status == l_Undef) {
-        // Run EA on restart:
-        if (ea) {
-            auto currentTime = std::chrono::steady_clock::now();
-            auto elapsedTime = std::chrono::duration_cast<std::chrono::seconds>(currentTime - startTime).count();
-            if (first || elapsedTime > 5 * 60) {
-                first = false;
+        // Feed the background search, and take up the backdoors it finds:
+        if (background) {
+            if (background->due()) {
                 cancelUntil(0);
-
-                std::vector<int> pool;
-                pool.reserve(nVars());
-                for (int i = 0; i < nVars(); ++i) {
-                    if (value(i) == l_Undef) {
-                        pool.push_back(i);
-                    }
-                }
-
-                std::ofstream outFile("backdoors.txt", std::ios::app);
-                if (outFile.is_open()) {
-                    outFile << "---" << std::endl;
-                } else {
-                    std::cout << "Error opening the file." << std::endl;
-                }
-                outFile.close();
-
-                std::string learntFilename = "learnts-" + std::to_string(runNumber) + ".txt";
-                std::cout << "Dumping " << learnts.size() << " learnts to '" << learntFilename << "'" << std::endl;
-                std::ofstream learntFile(learntFilename, std::ios::out | std::ios::trunc);
-                for (CRef ref : learnts) {
-                    Clause& learnt = ca[ref];
-                    for (int i = 0; i < learnt.size(); ++i) {
-                        int v = var(learnt[i]) + 1;
-                        if (sign(learnt[i])) learntFile << '-';
-                        learntFile << v << ' ';
-                    }
-                    learntFile << "0\n";
-                }
-                learntFile.close();
-
-                std::cout << "Running EA multiple times. runNumber = " << runNumber << std::endl;
-                runNumber++;
-                ea->cache.clear();
-                for (int i = 0; i < 100; ++i) {
-                    ea->run(1000, 10, pool, "backdoor.txt");
-                }
-
-                startTime = currentTime;
+                background->submit(*this);
+            }
+            if (std::unique_ptr<BackdoorResult> found = background->take()) {
+                if (verbosity >= 1)
+                    fprintf(stderr, "| Backdoor of %d variables from phase %d, fitness %g\n",
+                            (int)found->vars.size(), found->phase, found->fitness.fitness);
+                // Decide on them next: bump each one above the current top of the order
+                if (bump_backdoors && !order_heap.empty())
+                    for (int v : found->vars)
+                        varBumpActivity(v, activity[order_heap[0]] - activity[v] + var_inc);
             }
         }
 
@@ -1051,80 +1090,106 @@ bool Solver::prop_check(const vec<Lit>& assumps, vec<Lit>& prop, int psaving) {
 }
 
 bool Solver::gen_all_valid_assumptions_propcheck(
-    std::vector<int> d_set,
+    const std::vector<int>& d_set,
     uint64_t& total_count,
     std::vector<std::vector<int>>& vector_of_assumptions,
     bool verb) {
     vector_of_assumptions.clear();
+    return gen_all_valid_assumptions_propcheck(
+        d_set, total_count, [&](const std::vector<int>& cube) { vector_of_assumptions.push_back(cube); }, verb);
+}
+
+bool Solver::gen_all_valid_assumptions_propcheck(
+    const std::vector<int>& d_set,
+    uint64_t& total_count,
+    const CubeSink& sink,
+    bool verb) {
+    // Checks all 2^|d_set| points in Gray-code order, the last variable changing most often. Each
+    // point differs from the previous one in a single sign, so only the assumptions from the changed
+    // one on are undone and propagated again. While an assumption before the changed one fails, the
+    // point fails as well and nothing is propagated.
     total_count = 0;
-    int checked_points = 0;
+    uint64_t checked_points = 0;
 
     if (verb) {
         std::cout << "c checking backdoor: ";
-        for (int j = 0; j < d_set.size(); j++) {
+        for (size_t j = 0; j < d_set.size(); j++) {
             std::cout << d_set[j] + 1 << ' ';
         }
         std::cout << '\n';
     }
 
-    int d_size = d_set.size();
-
-    vec<Lit> assumps;
-    std::vector<int> aux(d_set.size());
-    for (int i = 0; i < d_set.size(); i++) {
-        aux[i] = 0;
-        assumps.push(~mkLit(d_set[i]));
+    // No hard tasks for the empty set, as in 'gen_all_valid_assumptions_tree':
+    if (d_set.empty()) {
+        return true;
     }
 
-    bool flag = true;
-    while (flag == true) {
+    assert(decisionLevel() == 0);
+    const int d_size = d_set.size();
+    std::vector<int> aux(d_size, 0);  // signs: 1 = positive
+    std::vector<int> level(d_size);   // decision level before assuming each variable
+    int failed = d_size;              // the first failing assumption of the current point, or 'd_size'
+    int from = 0;                     // the first assumption to (re)assume for the current point
+
+    // Dealing with phase saving (as 'prop_check' does):
+    int psaving_copy = phase_saving;
+    phase_saving = 0;
+
+    // Focus pointers of the loopless Gray-code generator (Knuth, Algorithm L); bit 'b' is the sign
+    // of variable 'd_size - 1 - b':
+    std::vector<int> focus(d_size + 1);
+    for (int b = 0; b <= d_size; b++) focus[b] = b;
+
+    while (true) {
         checked_points++;
-        for (int j = 0; j < d_size; j++) {
-            if (aux[j] == 0) {
-                assumps[j] = ~mkLit(d_set[j]);
-            } else {
-                assumps[j] = mkLit(d_set[j]);
+        if (from <= failed && ok) {
+            cancelUntil(level[from]);
+            failed = d_size;
+            for (int i = from; i < d_size; i++) {
+                level[i] = decisionLevel();
+                Lit p = aux[i] ? mkLit(d_set[i]) : ~mkLit(d_set[i]);
+                if (value(p) == l_False) {
+                    failed = i;
+                    break;
+                } else if (value(p) != l_True) {
+                    newDecisionLevel();
+                    uncheckedEnqueue(p);
+                    tree_nodes++;
+                    if (propagate() != CRef_Undef) {
+                        failed = i;
+                        break;
+                    }
+                }
             }
         }
-
-        vec<Lit> prop;
-        bool b = prop_check(assumps, prop);
-        cancelUntil(0);
-        if (b == true) {
-            vector_of_assumptions.push_back(aux);
+        if (failed == d_size && ok) {
+            if (sink) {
+                sink(aux);
+            }
             total_count++;
             if (verb) {
                 std::cout << "c valid vector of assumptions: ";
-                for (int j = 0; j < aux.size(); j++) {
+                for (size_t j = 0; j < aux.size(); j++) {
                     std::cout << aux[j] << ' ';
                 }
                 std::cout << '\n';
             }
         }
 
-        int g = aux.size() - 1;
-
-        while ((aux[g] == 1) && (g >= 0)) {
-            g--;
-        }
-        if (g == -1) {
-            // time to break;
-            flag = false;
-            break;
-        }
-
-        assert(aux[g] == 0);
-        aux[g] = 1;
-        // move to the next binary number
-        if (g < d_size) {
-            g++;
-            while (g < d_size) {
-                aux[g] = 0;
-                g++;
-            }
-        }
+        // Move to the next point:
+        int b = focus[0];
+        focus[0] = 0;
+        if (b == d_size) break;
+        focus[b] = focus[b + 1];
+        focus[b + 1] = b + 1;
+        from = d_size - 1 - b;
+        aux[from] ^= 1;
     }
     cancelUntil(0);
+
+    // restoring phase saving
+    phase_saving = psaving_copy;
+
     if (verb) {
         std::cout << "c Checked " << checked_points << " points, " << total_count << " valid" << '\n';
     }
@@ -1132,16 +1197,67 @@ bool Solver::gen_all_valid_assumptions_propcheck(
 }
 
 bool Solver::gen_all_valid_assumptions_tree(
-    std::vector<int> variables,
+    const std::vector<int>& variables,
     uint64_t& total_count,
     std::vector<std::vector<int>>& vector_of_assumptions,
     int limit,
-    bool verb) {
+    bool verb,
+    uint64_t cutoff) {
+    return gen_all_valid_assumptions_subtree(variables, {}, total_count, vector_of_assumptions, limit, verb, cutoff);
+}
+
+bool Solver::gen_all_valid_assumptions_tree(
+    const std::vector<int>& variables,
+    uint64_t& total_count,
+    const CubeSink& sink,
+    bool verb,
+    uint64_t cutoff) {
+    return gen_all_valid_assumptions_subtree(variables, {}, total_count, sink, verb, cutoff);
+}
+
+bool Solver::count_valid_assumptions_tree(
+    const std::vector<int>& variables,
+    uint64_t& total_count,
+    uint64_t cutoff) {
+    return gen_all_valid_assumptions_subtree(variables, {}, total_count, CubeSink(), false, cutoff);
+}
+
+bool Solver::gen_all_valid_assumptions_subtree(
+    const std::vector<int>& variables,
+    const std::vector<int>& prefix,
+    uint64_t& total_count,
+    std::vector<std::vector<int>>& vector_of_assumptions,
+    int limit,
+    bool verb,
+    uint64_t cutoff) {
+    // 'vector_of_assumptions' - vector of hard tasks (no more than 'limit')
+    vector_of_assumptions.clear();
+    CubeSink sink;
+    if (limit > 0) {
+        sink = [&](const std::vector<int>& cube) {
+            if (vector_of_assumptions.size() < static_cast<size_t>(limit)) {
+                vector_of_assumptions.push_back(cube);
+            }
+        };
+    }
+    return gen_all_valid_assumptions_subtree(variables, prefix, total_count, sink, verb, cutoff);
+}
+
+bool Solver::gen_all_valid_assumptions_subtree(
+    const std::vector<int>& variables,
+    const std::vector<int>& prefix,
+    uint64_t& total_count,
+    const CubeSink& sink,
+    bool verb,
+    uint64_t cutoff) {
     // 'variables' - vector of variables (backdoor)
+    // 'prefix' - fixed signs of the first 'prefix.size()' variables (empty for the whole tree)
     // 'total_count' - number of found hard tasks
-    // 'vector_of_assumptions' - vector of hard tasks (no more than 'limit')
+    // 'sink' - receives the hard tasks (empty for counting only)
+    // 'cutoff' - stop once more than 'cutoff' hard tasks are found ('total_count' is then a lower bound)
 
-    assert(variables.size() < 64);
+    assert(prefix.size() <= variables.size());
+    const int fixed = prefix.size();
 
     if (verb) {
         std::cerr << "c checking backdoor: ";
@@ -1154,15 +1270,21 @@ bool Solver::gen_all_valid_assumptions_tree(
     assert(ok);
     cancelUntil(0);
 
+    PackedCube& cube = subtree_cube;  // signs
+    cube.reset(variables.size());
+    for (int i = 0; i < fixed; i++) {
+        cube.set(i, prefix[i]);
+    }
+    std::vector<int>& signs = subtree_signs;  // unpacked 'cube' for the sink
+
     assumptions.clear();
     for (size_t i = 0; i < variables.size(); i++) {
-        assumptions.push(mkLit(variables[i], false));
+        assumptions.push(mkLit(variables[i], cube[i]));
     }
 
-    std::vector<int> cube(variables.size(), 0);  // signs
     uint64_t total_checked = 0;                  // number of 'propagate' calls
+    bool complete = true;                        // false if stopped by 'cutoff'
     total_count = 0;                             // number of found valid cubes
-    vector_of_assumptions.clear();               // valid cubes (hard subtasks)
 
     if (variables.size() == 0) {
         return true;
@@ -1197,10 +1319,15 @@ bool Solver::gen_all_valid_assumptions_tree(
                     }
                     std::cerr << '\n';
                 }
-                if (vector_of_assumptions.size() < limit) {
-                    vector_of_assumptions.push_back(cube);
+                if (sink) {
+                    cube.unpack(signs);
+                    sink(signs);
                 }
                 total_count++;
+                if (total_count > cutoff) {
+                    complete = false;
+                    break;
+                }
                 state = 1;  // state = Ascending
             } else {
                 while (decisionLevel() < variables.size()) {
@@ -1235,20 +1362,12 @@ bool Solver::gen_all_valid_assumptions_tree(
 
             assert(decisionLevel() > 0);
 
-            int i = decisionLevel();  // 1-based index
-            while (i > 0 && cube[i - 1]) {
-                i--;
-            }
-            if (i == 0) {
-                // Finish.
+            // Next cube: flip the last zero sign below the current level, clearing the ones after it.
+            int i = cube.increment(fixed, decisionLevel()) + 1;  // 1-based index
+            if (i <= fixed) {
+                // Finish (the whole subtree under the prefix is done).
                 break;
             }
-
-            assert(cube[i - 1] == 0);
-            cube[i - 1] = 1;
-            for (int j = i; j < variables.size(); j++) {
-                cube[j] = 0;
-            }
             // if (verb) {
             //     std::cerr << "c next cube: ";
             //     for (int j = 0; j < variables.size(); j++) {
@@ -1273,6 +1392,7 @@ bool Solver::gen_all_valid_assumptions_tree(
 
             CRef confl = propagate();
             total_checked++;
+            tree_nodes++;
             if (confl != CRef_Undef) {
                 // CONFLICT
 
@@ -1311,5 +1431,140 @@ bool Solver::gen_all_valid_assumptions_tree(
         std::cout << "c Checked: " << total_checked << ", found valid: " << total_count << '\n';
     }
     assumptions.clear();
+    return complete;
+}
+
+// Counts the hard leaves of the cube tree over 'vars' below the current node at 'level' (one
+// decision level per variable). 'signs' holds the signs chosen so far, one bit per level (only the
+// last 64 levels are kept, enough for the marks, which are at most 63 levels deep). The
+// nodes reached at 'mark_level' are appended to 'marks' (if given). Returns false once the
+// count exceeds 'cutoff'.
+bool Solver::count_subtree(
+    const std::vector<int>& vars,
+    int level,
+    uint64_t signs,
+    uint64_t& total_count,
+    uint64_t cutoff,
+    int mark_level,
+    std::vector<uint64_t>* marks) {
+    if (marks && level == mark_level) {
+        marks->push_back(signs);
+    }
+    if (level == static_cast<int>(vars.size())) {
+        return ++total_count <= cutoff;
+    }
+    for (int s = 0; s < 2; s++) {
+        Lit p = mkLit(vars[level], s);
+        if (value(p) == l_False) continue;
+        newDecisionLevel();
+        bool go_on = true;
+        if (value(p) == l_True) {
+            go_on = count_subtree(vars, level + 1, signs << 1 | s, total_count, cutoff, mark_level, marks);
+        } else {
+            uncheckedEnqueue(p);
+            if (propagate() == CRef_Undef) {
+                go_on = count_subtree(vars, level + 1, signs << 1 | s, total_count, cutoff, mark_level, marks);
+            }
+        }
+        cancelUntil(level);
+        if (!go_on) return false;
+    }
     return true;
 }
+
+bool Solver::gen_all_valid_assumptions_incremental(
+    const std::vector<int>& shared,
+    const std::vector<int>& changed,
+    const std::vector<uint64_t>* alive,
+    std::vector<uint64_t>* record,
+    uint64_t& total_count,
+    uint64_t cutoff) {
+    // 'shared' - backdoor variables shared with the parent (walked first)
+    // 'changed' - the remaining backdoor variables
+    // 'alive' - memoized non-conflicting nodes at depth |shared| (nullptr to walk the full tree)
+    // 'record' - receives the non-conflicting nodes at depth |shared| of a full walk
+    // 'total_count' - number of found hard tasks
+    // 'cutoff' - stop once more than 'cutoff' hard tasks are found ('record' is then incomplete)
+
+    assert(ok);
+    assert(shared.size() < 64);
+    cancelUntil(0);
+    total_count = 0;
+
+    const int u = shared.size();
+    std::vector<int>& vars = incremental_vars;
+    vars.assign(shared.begin(), shared.end());
+    vars.insert(vars.end(), changed.begin(), changed.end());
+
+    if (alive == nullptr) {
+        bool complete = count_subtree(vars, 0, 0, total_count, cutoff, u, record);
+        cancelUntil(0);
+        return complete;
+    }
+
+    // Visit the memoized prefixes in lexicographic order, keeping the common part on the trail:
+    bool complete = true;
+    uint64_t prev = 0;
+    for (uint64_t signs : *alive) {
+        int from = 0;
+        if (decisionLevel() > 0) {
+            uint64_t diff = signs ^ prev;
+            if (diff == 0) continue;
+            int highest = PackedCube::highestBit(diff);
+            from = std::min(u - 1 - highest, decisionLevel());
+        }
+        cancelUntil(from);
+        prev = signs;
+
+        int j = from;
+        for (; j < u; ++j) {
+            Lit p = mkLit(shared[j], (signs >> (u - 1 - j)) & 1);
+            if (value(p) == l_False) break;
+            newDecisionLevel();
+            if (value(p) == l_Undef) {
+                uncheckedEnqueue(p);
+                if (propagate() != CRef_Undef) {
+                    cancelUntil(j);
+                    break;
+                }
+            }
+        }
+        if (j == u && !count_subtree(vars, u, signs, total_count, cutoff, -1, nullptr)) {
+            complete = false;
+            break;
+        }
+    }
+
+    cancelUntil(0);
+    return complete;
+}
+
+uint64_t Solver::sample_valid_assumptions(
+    const std::vector<int>& variables,
+    uint64_t samples,
+    std::mt19937& gen) {
+    // Same check as 'prop_check' on a random cube, stopping at the first conflict and
+    // without copying the propagated literals.
+    assert(ok);
+    cancelUntil(0);
+
+    uint64_t hard = 0;
+    for (uint64_t n = 0; n < samples; ++n) {
+        bool conflict = false;
+        uint32_t bits = 0;
+        for (size_t j = 0; j < variables.size() && !conflict; ++j) {
+            if (j % 32 == 0) bits = gen();
+            Lit p = mkLit(variables[j], (bits >> (j % 32)) & 1);
+            if (value(p) == l_False) {
+                conflict = true;
+            } else if (value(p) == l_Undef) {
+                newDecisionLevel();
+                uncheckedEnqueue(p);
+                conflict = propagate() != CRef_Undef;
+            }
+        }
+        if (!conflict) hard++;
+        cancelUntil(0);
+    }
+    return hard;
+}
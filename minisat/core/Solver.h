@@ -21,10 +21,15 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef Minisat_Solver_h
 #define Minisat_Solver_h
 
+#include <functional>
+#include <random>
+#include <vector>
+
 #include "minisat/mtl/Vec.h"
 #include "minisat/mtl/Heap.h"
 #include "minisat/mtl/Alg.h"
 #include "minisat/utils/Options.h"
+#include "minisat/utils/PackedCube.h"
 #include "minisat/core/SolverTypes.h"
 #include "minisat/core/EA.h"
 
@@ -34,7 +39,7 @@ namespace Minisat {
 //=================================================================================================
 // Solver -- the main class:
 
-class EvolutionaryAlgorithm;
+class BackgroundSearch;
 
 class Solver {
 public:
@@ -44,9 +49,16 @@ public:
     Solver();
     virtual ~Solver();
 
-    // Evolutionary algorithm
+    // Backdoor search fed with a snapshot of the clauses at restarts (see 'BackgroundSearch'):
+    //
+    BackgroundSearch* background;
+    bool              bump_backdoors;  // Move the variables of the backdoors it finds to the top of the decision order.
+
+    // Called with every learnt clause of at most 'learnt_export_size' literals and its LBD (number of
+    // decision levels), e.g. to share it with other solvers:
     //
-    EvolutionaryAlgorithm* ea;
+    std::function<void(const vec<Lit>&, int)> learnt_export;
+    int                                       learnt_export_size;
 
     // Problem specification:
     //
@@ -59,6 +71,9 @@ public:
     bool    addClause (Lit p, Lit q, Lit r);                    // Add a ternary clause to the solver.
     bool    addClause_(      vec<Lit>& ps);                     // Add a clause to the solver without making superflous internal copy. Will
                                                                 // change the passed vector 'ps'.
+    void    copyTo    (Solver& copy) const;                     // Copy variables, top-level units and problem clauses into a fresh solver.
+    int     exportClauses(std::vector<int>& lits, bool learnt) const; // Append top-level units and problem clauses, or the learnt clauses, as 0-terminated DIMACS literals; returns their number.
+    void    forEachLearnt(const std::function<void(const Clause&)>& f) const; // Call 'f' with every learnt clause in the database.
 
     // Solving:
     //
@@ -70,6 +85,7 @@ public:
     bool    solve        (Lit p, Lit q);            // Search for a model that respects two assumptions.
     bool    solve        (Lit p, Lit q, Lit r);     // Search for a model that respects three assumptions.
     bool    okay         () const;                  // FALSE means solver is in a conflicting state
+    bool    prop_check   (const vec<Lit>& assumps, vec<Lit>& prop, int psaving = 0); // Compute a list of propagated literals given a set of assumptions (at level 0: false on conflict).
 
     // Iterate over clauses:
     ClauseIterator clausesBegin() const;
@@ -148,6 +164,7 @@ public:
     //
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
     uint64_t dec_vars, clauses_literals, learnts_literals, max_literals, tot_literals;
+    uint64_t tree_nodes;  // cube tree nodes propagated by 'gen_all_valid_assumptions_*'
 
 protected:
 
@@ -210,6 +227,11 @@ protected:
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<uint64_t>       lbd_seen;         // Per decision level: the last 'lbd_stamp' it was counted for.
+    uint64_t            lbd_stamp;
+    PackedCube          subtree_cube;     // Signs of the current cube of 'gen_all_valid_assumptions_subtree'.
+    std::vector<int>    subtree_signs;    // 'subtree_cube' unpacked for the sink.
+    std::vector<int>    incremental_vars; // Variables walked by 'gen_all_valid_assumptions_incremental'.
 
     double              max_learnts;
     double              learntsize_adjust_confl;
@@ -229,11 +251,11 @@ protected:
     void     uncheckedEnqueue (Lit p, CRef from = CRef_Undef);                         // Enqueue a literal. Assumes value of literal is undefined.
     bool     enqueue          (Lit p, CRef from = CRef_Undef);                         // Test if fact 'p' contradicts current state, enqueue otherwise.
     CRef     propagate        ();                                                      // Perform unit propagation. Returns possibly conflicting clause.
-    bool     prop_check(const vec<Lit>& assumps, vec<Lit>& prop, int psaving = 0);     // Compute a list of propagated literals given a set of assumptions.
     void     cancelUntil      (int level);                                             // Backtrack until a certain level.
     void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel);    // (bt = backtrack)
     void     analyzeFinal     (Lit p, vec<Lit>& out_conflict);                         // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p, uint32_t abstract_levels);                       // (helper method for 'analyze()')
+    int      computeLBD       (const vec<Lit>& c);                                     // Number of distinct decision levels of the literals in 'c'.
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
     lbool    solve_           ();                                                      // Main solve method (assumptions given in 'assumptions').
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
@@ -284,8 +306,26 @@ protected:
 
     // Extra prop-related stuff:
 public:
-    bool gen_all_valid_assumptions_propcheck(std::vector<int> d_set, uint64_t& total_count, std::vector<std::vector<int>>& vector_of_assumptions, bool verb=false);
-    bool gen_all_valid_assumptions_tree(std::vector<int> d_set, uint64_t& total_count, std::vector<std::vector<int>>& vector_of_assumptions, int limit, bool verb=false);
+    // Receives each hard task as the signs (0/1) of the backdoor variables: the tree walks pass them
+    // in lexicographic order (1 = negative), 'propcheck' in Gray-code order (1 = positive). The
+    // vector is only valid during the call.
+    using CubeSink = std::function<void(const std::vector<int>& cube)>;
+
+    bool gen_all_valid_assumptions_propcheck(const std::vector<int>& d_set, uint64_t& total_count, std::vector<std::vector<int>>& vector_of_assumptions, bool verb=false);
+    bool gen_all_valid_assumptions_propcheck(const std::vector<int>& d_set, uint64_t& total_count, const CubeSink& sink, bool verb=false);
+    // The tree walks stop (and return false) as soon as more than 'cutoff' hard tasks are found:
+    bool gen_all_valid_assumptions_tree(const std::vector<int>& d_set, uint64_t& total_count, std::vector<std::vector<int>>& vector_of_assumptions, int limit, bool verb=false, uint64_t cutoff=UINT64_MAX);
+    bool gen_all_valid_assumptions_tree(const std::vector<int>& d_set, uint64_t& total_count, const CubeSink& sink, bool verb=false, uint64_t cutoff=UINT64_MAX);
+    bool gen_all_valid_assumptions_subtree(const std::vector<int>& d_set, const std::vector<int>& prefix, uint64_t& total_count, std::vector<std::vector<int>>& vector_of_assumptions, int limit, bool verb=false, uint64_t cutoff=UINT64_MAX);
+    bool gen_all_valid_assumptions_subtree(const std::vector<int>& d_set, const std::vector<int>& prefix, uint64_t& total_count, const CubeSink& sink, bool verb=false, uint64_t cutoff=UINT64_MAX);
+    // Counting only, nothing is allocated per hard task:
+    bool count_valid_assumptions_tree(const std::vector<int>& d_set, uint64_t& total_count, uint64_t cutoff=UINT64_MAX);
+    // Number of hard tasks among 'samples' uniformly random cubes over 'd_set':
+    uint64_t sample_valid_assumptions(const std::vector<int>& d_set, uint64_t samples, std::mt19937& gen);
+    bool gen_all_valid_assumptions_incremental(const std::vector<int>& shared, const std::vector<int>& changed, const std::vector<uint64_t>* alive, std::vector<uint64_t>* record, uint64_t& total_count, uint64_t cutoff=UINT64_MAX);
+
+protected:
+    bool count_subtree(const std::vector<int>& vars, int level, uint64_t signs, uint64_t& total_count, uint64_t cutoff, int mark_level, std::vector<uint64_t>* marks);
 };
 
 
@@ -0,0 +1,162 @@
+#include "minisat/core/Strategy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+#include "minisat/core/EA.h"
+#include "minisat/core/Instance.h"
+
+namespace Minisat {
+
+void SearchStrategy::apply(EvolutionaryAlgorithm &ea, Instance &current, size_t index, size_t poolIndex) {
+    ea.applySwap(current, index, poolIndex);
+}
+
+Fitness SearchStrategy::evaluate(EvolutionaryAlgorithm &ea, Instance &current, const Fitness *threshold) {
+    return ea.calculateFitness(current, &ea.parent, threshold);
+}
+
+void SearchStrategy::evaluateAll(EvolutionaryAlgorithm &ea, std::vector<Instance> &instances, std::vector<Fitness> &fitness,
+                                 const Fitness *threshold) {
+    ea.evaluateBatch(instances, fitness, threshold);
+}
+
+size_t SearchStrategy::pickPoolIndex(EvolutionaryAlgorithm &ea, const std::vector<int> &pool) {
+    return ea.pickPoolIndex(pool);
+}
+
+Fitness SearchStrategy::exact(EvolutionaryAlgorithm &ea, Instance &instance, const Fitness &fitness) {
+    if (fitness.exact()) return fitness;
+    instance._cached_fitness.reset();
+    return ea.calculateFitness(instance);
+}
+
+//=================================================================================================
+// Tabu search:
+
+void TabuSearch::reset(const Instance &, const Fitness &fitness) {
+    expires.clear();
+    best = fitness;
+}
+
+// The best fitness seen (doubles as hexadecimal floats, read back exactly), then the variables
+// still tabu as pairs of variable and expiry
+std::string TabuSearch::save() const {
+    std::ostringstream os;
+    os << std::hexfloat << best.fitness << ' ' << best.rho << ' ' << best.error << std::defaultfloat << ' ' << best.hard
+       << ' ' << best.lowerBound << ' ' << expires.size();
+    for (size_t v = 0; v < expires.size(); ++v) {
+        if (expires[v] != 0) os << ' ' << v << ' ' << expires[v];
+    }
+    return os.str();
+}
+
+void TabuSearch::restore(const std::string &state) {
+    std::istringstream is(state);
+    std::string token;
+    double *values[] = {&best.fitness, &best.rho, &best.error};
+    for (double *x : values) {
+        is >> token;
+        *x = std::strtod(token.c_str(), nullptr);
+    }
+    size_t n = 0;
+    is >> best.hard >> best.lowerBound >> n;
+    expires.assign(is ? n : 0, 0);
+    size_t v = 0;
+    int expiry = 0;
+    while (is >> v >> expiry) {
+        if (v < expires.size()) expires[v] = expiry;
+    }
+}
+
+bool TabuSearch::step(EvolutionaryAlgorithm &ea, int iteration, int, Instance &current, const Fitness &,
+                      Fitness &candidateFitness) {
+    if (expires.empty()) expires.assign(ea.solver.nVars(), 0);
+    const size_t size = current.size(), poolSize = current.pool.size();
+
+    moves.clear();
+    if (neighbours <= 0 || (uint64_t)neighbours >= (uint64_t)size * poolSize) {
+        for (size_t i = 0; i < size; ++i) {
+            for (size_t j = 0; j < poolSize; ++j) moves.emplace_back(i, j);
+        }
+    } else {
+        std::uniform_int_distribution<size_t> dis_index(0, size - 1);
+        for (int k = 0; k < neighbours; ++k) {
+            size_t i = dis_index(ea.gen);
+            moves.emplace_back(i, pickPoolIndex(ea, current.pool));
+        }
+    }
+
+    int chosen = -1;
+    bool chosenAdmissible = false;
+    candidateFitness = Fitness{};
+    for (size_t start = 0; start < moves.size(); start += batchSize) {
+        size_t end = std::min(moves.size(), start + batchSize);
+        // The neighbours are kept between iterations, so their slots are copied without allocating:
+        while (batch.size() < end - start) batch.emplace_back(std::vector<int>{}, std::vector<int>{});
+        batch.erase(batch.begin() + (end - start), batch.end());
+        for (size_t m = start; m < end; ++m) {
+            Instance &neighbour = batch[m - start];
+            neighbour.data = current.data;
+            neighbour.hash = current.hash;
+            neighbour.count = current.count;
+            neighbour.omega = current.omega;
+            neighbour.pool.assign(1, current.pool[moves[m].second]);
+            neighbour.pool_holes.assign(neighbour.pool[0] == -1, 0);
+            neighbour.swapWithPool(moves[m].first, 0);
+            neighbour.pool.clear();
+            neighbour.pool_holes.clear();
+        }
+        // Only neighbours better than the best admissible one so far matter:
+        evaluateAll(ea, batch, fits, ea.earlyAbort && chosenAdmissible ? &candidateFitness : nullptr);
+        for (size_t m = start; m < end; ++m) {
+            const Fitness &f = fits[m - start];
+            int added = current.pool[moves[m].second];
+            bool admissible = added == -1 || expires[added] <= iteration || (!f.lowerBound && f < best);
+            // The best admissible move, or the best move at all if none is admissible:
+            if (chosen == -1 || (admissible && !chosenAdmissible) || (admissible == chosenAdmissible && f < candidateFitness)) {
+                chosen = m;
+                chosenAdmissible = admissible;
+                candidateFitness = f;
+            }
+        }
+    }
+    if (chosen == -1) return false;  // no neighbours: empty pool
+
+    int removed = current.data[moves[chosen].first];
+    apply(ea, current, moves[chosen].first, moves[chosen].second);
+    current._cached_fitness = candidateFitness;
+    candidateFitness = exact(ea, current, candidateFitness);
+    if (removed != -1) expires[removed] = iteration + 1 + (tenure > 0 ? tenure : current.numVariables());
+    if (candidateFitness < best) best = candidateFitness;
+    return true;
+}
+
+//=================================================================================================
+// Simulated annealing:
+
+bool SimulatedAnnealing::step(EvolutionaryAlgorithm &ea, int iteration, int numIterations, Instance &current, const Fitness &fit,
+                              Fitness &candidateFitness) {
+    double progress = numIterations > 1 ? double(iteration - 1) / (numIterations - 1) : 0;
+    double temperature = startTemperature * std::pow(endTemperature / startTemperature, progress);
+
+    std::uniform_int_distribution<size_t> dis_index(0, current.size() - 1);
+    size_t i = dis_index(ea.gen);
+    apply(ea, current, i, pickPoolIndex(ea, current.pool));
+
+    // Taken if the fitness is at most 'limit':
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    double u = 1 - dis(ea.gen);  // in (0, 1]
+    Fitness limit = fit;
+    limit.fitness = fit.fitness * (1 - temperature * std::log(u));
+
+    candidateFitness = evaluate(ea, current, ea.earlyAbort ? &limit : nullptr);
+    if (candidateFitness.lowerBound || candidateFitness.fitness > limit.fitness) return false;
+    candidateFitness = exact(ea, current, candidateFitness);
+    return true;
+}
+
+}  // namespace Minisat
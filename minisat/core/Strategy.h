@@ -0,0 +1,92 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "minisat/core/Fitness.h"
+
+namespace Minisat {
+
+class EvolutionaryAlgorithm;
+struct Instance;
+
+// A single-trajectory local search over backdoors, run by 'EvolutionaryAlgorithm::run' in place
+// of the (1+1) EA. Every iteration the strategy evaluates one or more moves from the current
+// instance, applies one in place and decides whether to keep it. All evaluations go through the
+// EA, so its cache, engines, early abort, batch threads and budgets apply as they do to the EA.
+class SearchStrategy {
+   public:
+    virtual ~SearchStrategy() = default;
+
+    [[nodiscard]] virtual const char *name() const = 0;
+
+    // Called at the start of every run with the initial instance
+    virtual void reset(const Instance &/*current*/, const Fitness &/*fitness*/) {}
+
+    // State carried between iterations, for checkpoints. A resumed run calls 'restore' with the
+    // saved state instead of 'reset'.
+    [[nodiscard]] virtual std::string save() const { return {}; }
+    virtual void restore(const std::string &/*state*/) {}
+
+    // One iteration (1-based, of 'numIterations') from 'current' of fitness 'fit'. The move is
+    // applied to 'current' with 'apply', and its fitness stored in 'candidateFitness'. Returns
+    // true to keep the move; otherwise the EA undoes it.
+    virtual bool step(EvolutionaryAlgorithm &ea, int iteration, int numIterations, Instance &current, const Fitness &fit,
+                      Fitness &candidateFitness) = 0;
+
+   protected:
+    // Access to the evaluation of the EA running the strategy:
+    static void apply(EvolutionaryAlgorithm &ea, Instance &current, size_t index, size_t poolIndex);
+    // Fitness of 'current' after 'apply', evaluated incrementally from the instance before the move
+    static Fitness evaluate(EvolutionaryAlgorithm &ea, Instance &current, const Fitness *threshold);
+    static void evaluateAll(EvolutionaryAlgorithm &ea, std::vector<Instance> &instances, std::vector<Fitness> &fitness,
+                            const Fitness *threshold);
+    static size_t pickPoolIndex(EvolutionaryAlgorithm &ea, const std::vector<int> &pool);
+    // The exact fitness of 'instance' if 'fitness' is a lower bound or an estimate
+    static Fitness exact(EvolutionaryAlgorithm &ea, Instance &instance, const Fitness &fitness);
+};
+
+// Tabu search: every iteration scans single-swap neighbours (one backdoor variable exchanged for a
+// pool variable) in batches and moves to the best one, even if it is worse. A variable swapped out
+// can not come back for 'tenure' iterations, unless that would improve on the best fitness seen.
+class TabuSearch : public SearchStrategy {
+   public:
+    int tenure = 0;         // 0 = the number of backdoor variables
+    int neighbours = 16;    // scanned per iteration, drawn at random; 0 = all of them
+    size_t batchSize = 32;  // neighbours evaluated in one batch
+
+    [[nodiscard]] const char *name() const override { return "tabu"; }
+    void reset(const Instance &current, const Fitness &fitness) override;
+    [[nodiscard]] std::string save() const override;
+    void restore(const std::string &state) override;
+    bool step(EvolutionaryAlgorithm &ea, int iteration, int numIterations, Instance &current, const Fitness &fit,
+              Fitness &candidateFitness) override;
+
+   private:
+    std::vector<int> expires;  // per variable: first iteration it may enter the backdoor again
+    Fitness best{};
+    std::vector<std::pair<size_t, size_t>> moves;  // (backdoor index, pool index)
+    std::vector<Instance> batch;  // the neighbours, without a pool
+    std::vector<Fitness> fits;
+};
+
+// Simulated annealing on random single-swap moves. A move that is worse by the relative amount
+// d = (new - current) / current is taken with probability exp(-d / T); the temperature T falls
+// geometrically from 'startTemperature' to 'endTemperature' over the iterations of a run. The
+// acceptance limit is drawn before the move is evaluated, so early abort still applies.
+class SimulatedAnnealing : public SearchStrategy {
+   public:
+    double startTemperature = 0.5;
+    double endTemperature = 0.01;
+
+    [[nodiscard]] const char *name() const override { return "sa"; }
+    bool step(EvolutionaryAlgorithm &ea, int iteration, int numIterations, Instance &current, const Fitness &fit,
+              Fitness &candidateFitness) override;
+};
+
+}  // namespace Minisat
+
+#endif
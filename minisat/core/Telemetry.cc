@@ -0,0 +1,109 @@
+#include "minisat/core/Telemetry.h"
+
+#include <inttypes.h>
+
+#include <cmath>
+
+namespace Minisat {
+
+namespace {
+
+// JSON has no infinities; they are written as null
+void putDouble(FILE *f, double x) {
+    if (std::isfinite(x)) {
+        fprintf(f, "%.17g", x);
+    } else {
+        fputs("null", f);
+    }
+}
+
+void putBuckets(FILE *f, const Histogram &h, char separator) {
+    for (size_t k = 0; k < h.buckets.size(); ++k) {
+        if (k > 0) fputc(separator, f);
+        fprintf(f, "%" PRIu64, h.buckets[k]);
+    }
+}
+
+}  // namespace
+
+Telemetry::Telemetry(const std::string &path, Format format, int every) : format(format), every(every > 0 ? every : 1) {
+    file = fopen(path.c_str(), "w");
+    if (format == Format::Csv) {
+        runs_file = fopen((path + ".runs.csv").c_str(), "w");
+        if (file) {
+            fputs("run,iteration,seconds,propagations,nodes,conflicts,cache_hits,cache_misses,"
+                  "accepted,improved,fitness,rho,hard,lower_bound,error,vars\n", file);
+        }
+        if (runs_file) {
+            fputs("run,iterations,reason,seconds,best_fitness,best_rho,best_hard,best_iteration,"
+                  "propagations,nodes,conflicts,cache_hits,cache_misses,cached_hits,cached_misses,early_aborts,"
+                  "eval_us_log2,hard_log2\n", runs_file);
+        }
+    }
+}
+
+Telemetry::~Telemetry() {
+    if (file) fclose(file);
+    if (runs_file) fclose(runs_file);
+}
+
+void Telemetry::iteration(const IterationSample &s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) return;
+    const Fitness &f = s.fitness;
+    if (format == Format::Csv) {
+        fprintf(file, "%d,%d,%.9f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%d,%d,",
+                s.run, s.iteration, s.seconds, s.propagations, s.nodes, s.conflicts, s.cacheHits, s.cacheMisses,
+                s.accepted, s.improved);
+        fprintf(file, "%.17g,%.17g,%" PRIu64 ",%d,%.17g,%d\n", f.fitness, f.rho, f.hard, f.lowerBound, f.error, s.numVars);
+        return;
+    }
+    fprintf(file, "{\"type\":\"iteration\",\"run\":%d,\"iteration\":%d,\"seconds\":%.9f,"
+                  "\"propagations\":%" PRIu64 ",\"nodes\":%" PRIu64 ",\"conflicts\":%" PRIu64 ","
+                  "\"cache_hits\":%" PRIu64 ",\"cache_misses\":%" PRIu64 ",\"accepted\":%d,\"improved\":%s,\"fitness\":",
+            s.run, s.iteration, s.seconds, s.propagations, s.nodes, s.conflicts, s.cacheHits, s.cacheMisses,
+            s.accepted, s.improved ? "true" : "false");
+    putDouble(file, f.fitness);
+    fputs(",\"rho\":", file);
+    putDouble(file, f.rho);
+    fprintf(file, ",\"hard\":%" PRIu64 ",\"lower_bound\":%s,\"error\":", f.hard, f.lowerBound ? "true" : "false");
+    putDouble(file, f.error);
+    fprintf(file, ",\"vars\":%d}\n", s.numVars);
+}
+
+void Telemetry::run(const RunSummary &s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (format == Format::Csv) {
+        if (!runs_file) return;
+        fprintf(runs_file, "%d,%d,%s,%.6f,%.17g,%.17g,%" PRIu64 ",%d,", s.run, s.iterations, toString(s.reason), s.seconds,
+                s.best.fitness, s.best.rho, s.best.hard, s.bestIteration);
+        fprintf(runs_file, "%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",",
+                s.propagations, s.nodes, s.conflicts, s.cacheHits, s.cacheMisses, s.cachedHits, s.cachedMisses, s.earlyAborts);
+        putBuckets(runs_file, s.evalMicros, ';');
+        fputc(',', runs_file);
+        putBuckets(runs_file, s.hard, ';');
+        fputc('\n', runs_file);
+        fflush(runs_file);
+        if (file) fflush(file);
+        return;
+    }
+    if (!file) return;
+    fprintf(file, "{\"type\":\"run\",\"run\":%d,\"iterations\":%d,\"reason\":\"%s\",\"seconds\":%.6f,\"best_fitness\":",
+            s.run, s.iterations, toString(s.reason), s.seconds);
+    putDouble(file, s.best.fitness);
+    fputs(",\"best_rho\":", file);
+    putDouble(file, s.best.rho);
+    fprintf(file, ",\"best_hard\":%" PRIu64 ",\"best_iteration\":%d,"
+                  "\"propagations\":%" PRIu64 ",\"nodes\":%" PRIu64 ",\"conflicts\":%" PRIu64 ","
+                  "\"cache_hits\":%" PRIu64 ",\"cache_misses\":%" PRIu64 ",\"cached_hits\":%" PRIu64 ",\"cached_misses\":%" PRIu64 ","
+                  "\"early_aborts\":%" PRIu64 ",\"eval_us_log2\":[",
+            s.best.hard, s.bestIteration, s.propagations, s.nodes, s.conflicts, s.cacheHits, s.cacheMisses,
+            s.cachedHits, s.cachedMisses, s.earlyAborts);
+    putBuckets(file, s.evalMicros, ',');
+    fputs("],\"hard_log2\":[", file);
+    putBuckets(file, s.hard, ',');
+    fputs("]}\n", file);
+    fflush(file);
+}
+
+}  // namespace Minisat
@@ -0,0 +1,94 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "minisat/core/Budget.h"
+#include "minisat/core/Fitness.h"
+
+namespace Minisat {
+
+// Counts of values by powers of two: bucket 0 holds 0, bucket k holds [2^(k-1), 2^k)
+struct Histogram {
+    std::vector<uint64_t> buckets;
+
+    void add(uint64_t value) {
+        size_t k = 0;
+        while (value != 0) value >>= 1, k++;
+        if (buckets.size() <= k) buckets.resize(k + 1, 0);
+        buckets[k]++;
+    }
+};
+
+// One iteration (generation) of an EA run. The work counters are the differences over the
+// iteration; 'nodes' and 'conflicts' are counted by the propagation engine only.
+struct IterationSample {
+    int run = 0;
+    int iteration = 0;
+    double seconds = 0;       // mutation and evaluation time
+    uint64_t propagations = 0;
+    uint64_t nodes = 0;       // cube tree nodes decided
+    uint64_t conflicts = 0;   // of which conflicting
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    int accepted = 0;         // offspring that entered the population
+    bool improved = false;    // the best fitness improved
+    Fitness fitness{};        // of the offspring, or of the best member of the population
+    int numVars = 0;
+};
+
+struct RunSummary {
+    int run = 0;
+    int iterations = 0;
+    StopReason reason = StopReason::None;
+    double seconds = 0;
+    Fitness best{};
+    int bestIteration = 0;
+    uint64_t propagations = 0;
+    uint64_t nodes = 0;
+    uint64_t conflicts = 0;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t cachedHits = 0;    // cache misses of instances carrying a fitness of their own
+    uint64_t cachedMisses = 0;
+    uint64_t earlyAborts = 0;
+    Histogram evalMicros;       // time per iteration in microseconds
+    Histogram hard;             // hard task counts of the evaluated offspring
+};
+
+// Machine-readable EA telemetry, shared by all runs and workers of a job.
+//
+// JSONL writes one object per line, with "type" "iteration" or "run". CSV writes the iteration
+// records to the file and the run summaries to '<path>.runs.csv', histograms as ';'-separated
+// buckets. Only every 'every'-th iteration is recorded; the histograms cover all of them.
+class Telemetry {
+   public:
+    enum class Format { Jsonl, Csv };
+
+    Telemetry(const std::string &path, Format format, int every);
+    ~Telemetry();
+
+    Telemetry(const Telemetry &) = delete;
+    Telemetry &operator=(const Telemetry &) = delete;
+
+    [[nodiscard]] bool isOpen() const { return file != nullptr && (format != Format::Csv || runs_file != nullptr); }
+    [[nodiscard]] bool sampled(int iteration) const { return iteration % every == 0; }
+
+    void iteration(const IterationSample &sample);
+    void run(const RunSummary &summary);
+
+   private:
+    std::mutex mutex;
+    Format format;
+    int every;
+    FILE *file = nullptr;
+    FILE *runs_file = nullptr;  // CSV only
+};
+
+}  // namespace Minisat
+
+#endif
@@ -0,0 +1,43 @@
+#include "minisat/core/VarScores.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "minisat/utils/ThreadPool.h"
+
+namespace Minisat {
+
+std::vector<double> propagationScores(const Solver &solver, const std::vector<int> &vars, int numThreads) {
+    std::vector<double> scores(solver.nVars(), 0);
+    numThreads = std::max(1, std::min<int>(numThreads, vars.size()));
+
+    std::vector<std::unique_ptr<Solver>> copies;
+    for (int t = 0; t < numThreads; ++t) {
+        copies.emplace_back(new Solver);
+        solver.copyTo(*copies.back());
+    }
+
+    auto score = [&](int worker, int index) {
+        Solver &s = *copies[worker];
+        Var v = vars[index];
+        vec<Lit> assumps, prop;
+        double implied[2];
+        for (int sign = 0; sign < 2; ++sign) {
+            assumps.clear();
+            assumps.push(mkLit(v, sign));
+            bool ok = s.prop_check(assumps, prop);
+            implied[sign] = ok ? std::max(prop.size() - 1, 0) : s.nVars();
+        }
+        scores[v] = (implied[0] + 1) * (implied[1] + 1);
+    };
+
+    if (numThreads == 1) {
+        for (int i = 0; i < static_cast<int>(vars.size()); ++i) score(0, i);
+    } else {
+        ThreadPool pool(numThreads);
+        pool.parallelFor(vars.size(), score);
+    }
+    return scores;
+}
+
+}  // namespace Minisat
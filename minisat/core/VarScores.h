@@ -0,0 +1,23 @@
+#ifndef VARSCORES_H
+#define VARSCORES_H
+
+#include <vector>
+
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+// Static propagation scores of variables, used to bias the EA towards variables whose
+// assignments propagate far.
+//
+// The score of 'v' is (a + 1) * (b + 1), where 'a' and 'b' are the numbers of literals implied
+// by propagating 'v' and '~v' at level 0. A polarity whose propagation conflicts counts as
+// implying every variable: such a variable halves the number of hard tasks on its own.
+//
+// The variables in 'vars' are probed on 'numThreads' copies of 'solver'. The result is indexed
+// by variable; variables not in 'vars' score 0.
+std::vector<double> propagationScores(const Solver &solver, const std::vector<int> &vars, int numThreads);
+
+}  // namespace Minisat
+
+#endif
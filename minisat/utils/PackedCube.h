@@ -0,0 +1,83 @@
+#ifndef PACKEDCUBE_H
+#define PACKEDCUBE_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace Minisat {
+
+// Signs of the variables of a cube, one bit per variable (position 'j' is bit 'j % 64' of word
+// 'j / 64'). Cubes are enumerated in lexicographic order with position 0 as the most significant
+// digit, and stepping to the next one is a carry over whole words, so the size is not bounded
+// by the width of a machine integer.
+class PackedCube {
+   public:
+    explicit PackedCube(size_t numVars = 0) : n(numVars), words((numVars + 63) / 64, 0) {}
+
+    [[nodiscard]] size_t size() const { return n; }
+
+    // Makes this the all-zero cube over 'numVars' variables (keeping the capacity)
+    void reset(size_t numVars) {
+        n = numVars;
+        words.assign((numVars + 63) / 64, 0);
+    }
+
+    bool operator[](size_t j) const {
+        return (words[j >> 6] >> (j & 63)) & 1;
+    }
+
+    void set(size_t j, bool sign) {
+        uint64_t bit = uint64_t(1) << (j & 63);
+        if (sign) {
+            words[j >> 6] |= bit;
+        } else {
+            words[j >> 6] &= ~bit;
+        }
+    }
+
+    // Increments the digits in [lo, hi): finds the last zero position 'j' in that range, sets it
+    // and clears every position after it. Returns 'j', or -1 (cube unchanged) on overflow.
+    int increment(int lo, int hi) {
+        assert(0 <= lo && lo <= hi && hi <= static_cast<int>(n));
+        if (lo == hi) return -1;
+        for (int k = (hi - 1) >> 6; k >= (lo >> 6); --k) {
+            uint64_t zeros = ~words[k];
+            if (k == (hi - 1) >> 6 && (hi & 63) != 0) zeros &= (uint64_t(1) << (hi & 63)) - 1;
+            if (k == (lo >> 6)) zeros &= ~uint64_t(0) << (lo & 63);
+            if (zeros == 0) continue;
+            int j = k * 64 + highestBit(zeros);
+            uint64_t bit = uint64_t(1) << (j & 63);
+            words[k] = (words[k] & (bit - 1)) | bit;
+            for (size_t w = k + 1; w < words.size(); ++w) words[w] = 0;
+            return j;
+        }
+        return -1;
+    }
+
+    void unpack(std::vector<int> &signs) const {
+        signs.resize(n);
+        for (size_t j = 0; j < n; ++j) signs[j] = (*this)[j];
+    }
+
+    // Index of the most significant set bit of a non-zero word
+    static int highestBit(uint64_t w) {
+        assert(w != 0);
+        int b = 0;
+        for (int step = 32; step > 0; step >>= 1) {
+            if (w >> step) {
+                w >>= step;
+                b += step;
+            }
+        }
+        return b;
+    }
+
+   private:
+    size_t n;
+    std::vector<uint64_t> words;
+};
+
+}  // namespace Minisat
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Minisat {
+
+// A fixed set of worker threads executing parallel loops.
+//
+// Indices are handed out dynamically from a shared counter, so a worker that finishes its
+// items early simply takes the next pending one. Each worker has a stable id in [0, size()),
+// which callers use to index per-worker state (e.g. solver copies).
+class ThreadPool {
+   public:
+    explicit ThreadPool(int numThreads) {
+        for (int id = 0; id < numThreads; ++id) {
+            threads.emplace_back([this, id] { loop(id); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    [[nodiscard]] int size() const {
+        return static_cast<int>(threads.size());
+    }
+
+    // Runs 'task(worker, index)' for every index in [0, n) and waits until all are done.
+    void parallelFor(int n, const std::function<void(int, int)> &task) {
+        if (n <= 0) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        current = &task;
+        total = n;
+        next = 0;
+        finished = 0;
+        generation++;
+        wake.notify_all();
+        idle.wait(lock, [this] { return finished == total && active == 0; });
+        current = nullptr;
+    }
+
+   private:
+    void loop(int id) {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(int, int)> *task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                if (current == nullptr) continue;  // woke up after the loop has completed
+                task = current;
+                active++;
+            }
+            int done = 0;
+            for (int index = next++; index < total; index = next++) {
+                (*task)(id, index);
+                done++;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            finished += done;
+            active--;
+            if (finished == total && active == 0) idle.notify_all();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    const std::function<void(int, int)> *current = nullptr;
+    std::atomic<int> next{0};
+    int total = 0;
+    int finished = 0;
+    int active = 0;  // workers currently inside the loop
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+}  // namespace Minisat
+
+#endif